@@ -0,0 +1,179 @@
+/*
+*** FILE NAME   : othello_analyze.c
+*** PURPOSE		: Annotates many positions with the scores of their best moves (multi-PV) on a pool of threads
+*** DESCRIPTION : The positions are read in the othello_cli format (64 board characters and the side to
+				  move per line) from the file given as the last argument or from the standard input.
+				  A pool of -threads workers takes the positions one by one and analyses each on its own
+				  thread with analyzePosition, all of them share one transposition table. For every
+				  position the best -multipv moves (all legal moves with -multipv 0) are printed with
+				  their score, depth and principal variation, one line per move that starts with the
+				  number of the position in the input, or one JSON line per position with -json. The
+				  positions per second and nodes per second of the whole batch are printed on the
+				  standard error at the end.
+				  Options: -threads <n>, -multipv <n>, -time <ms>, -depth <max depth>, -endgame <empties>,
+				  -hash <MB>, -eval <file>, -probcut <file>, -selectivity <sigmas>, -json
+*/
+
+#include <stdio.h>						// standard C libraries
+#include <stdlib.h>
+#include <string.h>
+#include <threads.h>
+#include "othello_engine.h"				// rules and search of the ai
+
+
+//@@***********************************************************************************@@
+// Constants
+#define ANALYZE_MULTIPV 3				// default number of moves analysed per position
+#define LINE_SIZE 256					// longest input line
+
+
+//@@***********************************************************************************@@
+// Structs
+
+// The batch that the workers share, read and printed under the lock
+typedef struct batch {
+	FILE* in;							// the positions
+	SearchLimits limits;				// limits of every analysis
+	int multiPv;						// moves analysed per position, 0 for all
+	int json;							// 1 to print JSON lines
+	mtx_t lock;
+	int next;							// number of the next position
+	int count;							// positions analysed
+	long long nodes;					// nodes of all the analyses
+} Batch;
+
+
+//@@***********************************************************************************@@
+// Function
+
+int analyzeThread(void* arg);								// thread entry, analyse positions until the input ends
+void printAnalysis(int index, Analysis* a);					// print one line per analysed move
+
+
+//@@***********************************************************************************@@
+int main(int argc, char **argv)
+{
+	// optional arguments: -threads <n>, -multipv <n>, -time <ms>, -depth <max depth>, -endgame <empties>, -hash <MB>, -eval <file>,
+	// -probcut <file>, -selectivity <sigmas>, -json, [file]
+	Batch b;
+	int threads = 1;
+	int hashMB = HASH_MB;
+	char* evalFile = NULL;
+	char* probcutFile = NULL;
+	char* fileName = NULL;
+	memset(&b, 0, sizeof(b));
+	defaultLimits(&b.limits);
+	b.multiPv = ANALYZE_MULTIPV;
+	int size = 8;
+	for (int i = 1; i < argc; i++) {
+		if (argv[i][0] != '-') fileName = argv[i];
+		else if (strcmp(argv[i], "-json") == 0) b.json = 1;
+		else if (i + 1 >= argc) break;
+		else if (strcmp(argv[i], "-threads") == 0) threads = atoi(argv[++i]);
+		else if (strcmp(argv[i], "-multipv") == 0) b.multiPv = atoi(argv[++i]);
+		else if (strcmp(argv[i], "-time") == 0) b.limits.msec = atoi(argv[++i]);
+		else if (strcmp(argv[i], "-depth") == 0) b.limits.maxDepth = atoi(argv[++i]);
+		else if (strcmp(argv[i], "-endgame") == 0) b.limits.endgameEmpties = atoi(argv[++i]);
+		else if (strcmp(argv[i], "-hash") == 0) hashMB = atoi(argv[++i]);
+		else if (strcmp(argv[i], "-eval") == 0) evalFile = argv[++i];
+		else if (strcmp(argv[i], "-probcut") == 0) probcutFile = argv[++i];
+		else if (strcmp(argv[i], "-selectivity") == 0) b.limits.probcut = atof(argv[++i]);
+		else if (strcmp(argv[i], "-size") == 0) size = atoi(argv[++i]);
+	}
+	if (size != 8) {												// the game records are 8x8 games
+		fprintf(stderr, "othello_analyze works on the 8x8 board only, -size %d is not supported.\n", size);
+		return 1;
+	}
+	if (threads < 1) threads = 1;
+	if (threads > MAX_THREADS) threads = MAX_THREADS;
+	if (!engineInit(hashMB)) {
+		fprintf(stderr, "Cannot allocate %d MB for the transposition table.\n", hashMB);
+		return 1;
+	}
+	if (!evalFile) patternLoad(PATTERN_FILE);					// the default weights are optional
+	else if (!patternLoad(evalFile)) {
+		fprintf(stderr, "Cannot load the weights from %s.\n", evalFile);
+		return 1;
+	}
+	if (!probcutFile) probcutLoad(PROBCUT_FILE);				// the default parameters are optional
+	else if (!probcutLoad(probcutFile)) {
+		fprintf(stderr, "Cannot load the multi-probcut parameters from %s, or they were fitted with another evaluation.\n", probcutFile);
+		return 1;
+	}
+	b.in = stdin;
+	if (fileName && !(b.in = fopen(fileName, "r"))) {
+		fprintf(stderr, "Cannot open %s.\n", fileName);
+		return 1;
+	}
+	if (mtx_init(&b.lock, mtx_plain) != thrd_success) return 1;
+
+	// the calling thread is the first worker
+	long long start = currentMsec();
+	thrd_t* ids = (thrd_t*)malloc(threads * sizeof(thrd_t));
+	int started = 1;
+	for (; ids && started < threads; started++) {
+		if (thrd_create(&ids[started], analyzeThread, &b) != thrd_success) break;
+	}
+	analyzeThread(&b);
+	for (int t = 1; t < started; t++) thrd_join(ids[t], NULL);
+	long long msec = currentMsec() - start;
+	if (b.in != stdin) fclose(b.in);
+
+	fprintf(stderr, "positions %d threads %d nodes %lld msec %lld positions/s %.1f nps %lld\n", b.count, started, b.nodes, msec,
+		msec > 0 ? b.count * 1000.0 / msec : 0.0, msec > 0 ? b.nodes * 1000 / msec : 0);
+	return 0;
+}
+
+//@@***********************************************************************************@@
+// thread entry, take the next position of the input and analyse it until the input ends
+int analyzeThread(void* arg) {
+	Batch* b = (Batch*)arg;
+	char line[LINE_SIZE];
+	Analysis* a = (Analysis*)malloc(sizeof(Analysis));
+	if (!a) return 0;
+
+	while (1) {
+		Position p;
+		int index = 0;
+		int found = 0;
+		mtx_lock(&b->lock);
+		while (found <= 0 && fgets(line, sizeof(line), b->in)) {
+			found = readPositionLine(line, &p);
+			if (found < 0) fprintf(stderr, "Skipped a line that is not a position: %s", line);
+			if (found > 0) index = ++b->next;
+		}
+		mtx_unlock(&b->lock);
+		if (found <= 0) break;
+
+		analyzePosition(&p, &b->limits, b->multiPv, a, NULL, NULL);
+
+		mtx_lock(&b->lock);
+		if (b->json) writeAnalysisJson(stdout, index, a);
+		else printAnalysis(index, a);
+		fflush(stdout);
+		b->count++;
+		b->nodes += a->nodes;
+		mtx_unlock(&b->lock);
+	}
+	free(a);
+	return 0;
+}
+
+//@@***********************************************************************************@@
+// print one line per analysed move: the number of the position, the rank, the move, its score and
+// depth and the principal variation. A position without moves prints a pass
+void printAnalysis(int index, Analysis* a) {
+	char name[16];
+
+	if (a->count == 0) printf("%d 1 pass\n", index);
+	for (int i = 0; i < a->count; i++) {
+		MoveAnalysis* m = &a->moves[i];
+		moveName(m->move, name);
+		printf("%d %d %s score %d depth %d%s pv", index, i + 1, name, m->score, m->depth, a->exact ? " exact" : "");
+		for (int j = 0; j < m->pvLength; j++) {
+			moveName(m->pv[j], name);
+			printf(" %s", name);
+		}
+		printf("\n");
+	}
+}
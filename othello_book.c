@@ -0,0 +1,332 @@
+/*
+*** FILE NAME   : othello_book.c
+*** PURPOSE		: Builds the opening book that the ai plays from without searching
+*** DESCRIPTION : The book scores moves of the positions near the start. A position and its rotations
+				  and mirrors share one canonicalKey, so every orientation of an opening finds it.
+				  The scores come from two sources that can be combined:
+				    - game records (moves like f5d6c3d3 and the final circle difference from black per
+				      line, as written by othello_tune -selfplay): every move of the first -plies
+				      plies gets the average result of the games that played it, from the side that
+				      played it, and moves with fewer than -min games are left out
+				    - deep searches (-search <plies>): every move of every distinct position up to that
+				      many plies from the start is searched with the -time, -depth, -endgame and
+				      -eval settings
+				  A move scored by both keeps the search score. The entries are sorted and written
+				  with bookSave, the game and the tools map the file with bookOpen.
+				  Options: -out <file>, -plies <n>, -min <games>, -search <plies>, -time <ms>,
+				  -depth <n>, -endgame <empties>, -eval <file>, files...
+*/
+
+#include <stdio.h>						// standard C libraries
+#include <stdlib.h>
+#include <string.h>
+#include "othello_engine.h"				// rules, search and book of the ai
+
+
+//@@***********************************************************************************@@
+// Constants
+#define BOOK_PLIES 20					// default plies of a game that go to the book
+#define BOOK_MIN_GAMES 2				// default fewest games of a move that goes to the book
+#define LINE_SIZE 1024					// longest input line
+
+
+//@@***********************************************************************************@@
+// Structs
+
+// A growing list of book entries, each move of a game is one entry until they are merged
+typedef struct entryList {
+	BookEntry* entries;
+	size_t count;
+	size_t size;
+} EntryList;
+
+// A position to search, kept in the orientation of its key
+typedef struct bookPosition {
+	uint64_t key;						// canonicalKey of the position
+	uint64_t player;					// circles of the side to move
+	uint64_t opponent;					// circles of the other side
+	int identity;						// side to move, 0: black, 1: white
+} BookPosition;
+
+
+//@@***********************************************************************************@@
+// Function
+
+int addEntry(EntryList* list, uint64_t key, int move, int score, int depth, int count);	// append an entry, return 0 when out of memory
+void addGame(EntryList* list, char* line, int plies);		// add the first plies moves of a game record with its result
+void mergeEntries(EntryList* list, int minGames);			// merge the entries of the same key and move
+int collectPositions(Position* p, int plies, BookPosition** list, int* n, int* size);	// add the positions up to plies moves away
+int comparePositions(const void* a, const void* b);			// order of the positions by key
+void searchMoves(EntryList* list, BookPosition* bp, SearchLimits* limits);	// score every move of a position with a search
+
+
+//@@***********************************************************************************@@
+int main(int argc, char **argv)
+{
+	// optional arguments: -out <file>, -plies <n>, -min <games>, -search <plies>, -time <ms>, -depth <n>, -endgame <empties>, -eval <file>, files...
+	SearchLimits limits;
+	char* outFile = BOOK_FILE;
+	char* evalFile = NULL;
+	int plies = BOOK_PLIES;
+	int minGames = BOOK_MIN_GAMES;
+	int searchPlies = -1;
+	char** files = (char**)malloc(argc * sizeof(char*));
+	int fileNum = 0;
+	defaultLimits(&limits);
+	int size = 8;
+	for (int i = 1; i < argc; i++) {
+		if (argv[i][0] != '-') files[fileNum++] = argv[i];
+		else if (i + 1 >= argc) break;
+		else if (strcmp(argv[i], "-out") == 0) outFile = argv[++i];
+		else if (strcmp(argv[i], "-plies") == 0) plies = atoi(argv[++i]);
+		else if (strcmp(argv[i], "-min") == 0) minGames = atoi(argv[++i]);
+		else if (strcmp(argv[i], "-search") == 0) searchPlies = atoi(argv[++i]);
+		else if (strcmp(argv[i], "-time") == 0) limits.msec = atoi(argv[++i]);
+		else if (strcmp(argv[i], "-depth") == 0) limits.maxDepth = atoi(argv[++i]);
+		else if (strcmp(argv[i], "-endgame") == 0) limits.endgameEmpties = atoi(argv[++i]);
+		else if (strcmp(argv[i], "-eval") == 0) evalFile = argv[++i];
+		else if (strcmp(argv[i], "-size") == 0) size = atoi(argv[++i]);
+	}
+	if (size != 8) {												// the book keys and the moves are 8x8 positions
+		fprintf(stderr, "othello_book works on the 8x8 board only, -size %d is not supported.\n", size);
+		return 1;
+	}
+	if (fileNum == 0 && searchPlies < 0) {
+		fprintf(stderr, "Usage: othello_book [options] [game files] [-search <plies>]\n");
+		return 1;
+	}
+	if (!engineInit(HASH_MB)) {
+		fprintf(stderr, "Cannot allocate the transposition table.\n");
+		return 1;
+	}
+	int patterns = evalFile ? patternLoad(evalFile) : patternLoad(PATTERN_FILE);
+	if (evalFile && !patterns) {
+		fprintf(stderr, "Cannot load the weights from %s.\n", evalFile);
+		return 1;
+	}
+
+	// the moves of the games, merged into their average results
+	EntryList list = { NULL, 0, 0 };
+	char line[LINE_SIZE];
+	for (int f = 0; f < fileNum; f++) {
+		FILE* in = fopen(files[f], "r");
+		if (!in) {
+			fprintf(stderr, "Cannot open %s.\n", files[f]);
+			return 1;
+		}
+		while (fgets(line, sizeof(line), in)) addGame(&list, line, plies);
+		fclose(in);
+	}
+	mergeEntries(&list, minGames);
+	printf("game moves %zu\n", list.count);
+
+	// the searched moves of the positions near the start
+	if (searchPlies >= 0) {
+		BookPosition* positions = NULL;
+		int n = 0, size = 0;
+		Position p;
+		startPosition(&p, 0);
+		if (!collectPositions(&p, searchPlies, &positions, &n, &size)) {
+			fprintf(stderr, "Out of memory.\n");
+			return 1;
+		}
+		qsort(positions, n, sizeof(BookPosition), comparePositions);
+		int unique = 0;
+		for (int i = 0; i < n; i++) {
+			if (unique == 0 || positions[i].key != positions[unique - 1].key) positions[unique++] = positions[i];
+		}
+		long long start = currentMsec();
+		for (int i = 0; i < unique; i++) {
+			searchMoves(&list, &positions[i], &limits);
+			printf("searched positions %d / %d msec %lld\n", i + 1, unique, currentMsec() - start);
+			fflush(stdout);
+		}
+		mergeEntries(&list, 0);
+		free(positions);
+	}
+
+	if (!bookSave(outFile, list.entries, list.count)) {
+		fprintf(stderr, "Cannot write %s.\n", outFile);
+		return 1;
+	}
+	printf("book entries %zu written to %s\n", list.count, outFile);
+	return 0;
+}
+
+//@@***********************************************************************************@@
+// append an entry to the list, return 0 when out of memory
+int addEntry(EntryList* list, uint64_t key, int move, int score, int depth, int count) {
+	if (list->count == list->size) {
+		size_t size = list->size ? 2 * list->size : 4096;
+		BookEntry* entries = (BookEntry*)realloc(list->entries, size * sizeof(BookEntry));
+		if (!entries) return 0;
+		list->entries = entries;
+		list->size = size;
+	}
+	BookEntry* e = &list->entries[list->count++];
+	e->key = key;
+	e->score = (int16_t)score;
+	e->move = (uint8_t)move;
+	e->depth = (uint8_t)depth;
+	e->count = (uint32_t)count;
+	return 1;
+}
+
+//@@***********************************************************************************@@
+// replay a game record and add its first plies moves, each with the result of the game from the side
+// that played it. Unfinished or illegal games are skipped
+void addGame(EntryList* list, char* line, int plies) {
+	uint64_t keys[BOARD_SIZE * BOARD_SIZE];
+	int moves[BOARD_SIZE * BOARD_SIZE];
+	int sides[BOARD_SIZE * BOARD_SIZE];
+	int n = 0;
+	char* s = line;
+	Position p;
+	Undo u;
+	int x;
+
+	while (*s == ' ' || *s == '\t') s++;
+	if (*s == '#' || *s == '\n' || *s == '\r' || *s == '\0') return;
+	startPosition(&p, 0);
+	for (; (x = readMove(s)) >= 0 && n < BOARD_SIZE * BOARD_SIZE; s += 2) {
+		uint64_t legal = getMoves(p.board.player, p.board.opponent);
+		if (!legal) {													// passes are not written in the record
+			makePass(&p);
+			legal = getMoves(p.board.player, p.board.opponent);
+		}
+		if (!((legal >> x) & 1)) return;								// not a legal game
+		int symmetries;
+		keys[n] = canonicalKey(p.board.player, p.board.opponent, &symmetries);
+		moves[n] = canonicalMove(x, symmetries);
+		sides[n] = p.identity;
+		n++;
+		makeMove(&p, x, &u);
+	}
+	if (getMoves(p.board.player, p.board.opponent) || getMoves(p.board.opponent, p.board.player)) return;	// unfinished game
+
+	int result = finalScore(p.board.player, p.board.opponent);
+	if (p.identity == 1) result = -result;								// from black
+	for (int i = 0; i < n && i < plies; i++) {
+		if (!addEntry(list, keys[i], moves[i], (sides[i] == 0 ? result : -result) * BOOK_UNIT, 0, 1)) return;
+	}
+}
+
+//@@***********************************************************************************@@
+// sort the list and merge the entries of the same key and move: the games add their counts and
+// average their scores, a searched entry keeps its own score. Game moves with fewer than minGames
+// games are dropped
+void mergeEntries(EntryList* list, int minGames) {
+	size_t n = 0;
+
+	if (list->count == 0) return;
+	qsort(list->entries, list->count, sizeof(BookEntry), compareBookEntries);
+	for (size_t i = 0; i < list->count; ) {
+		BookEntry merged = list->entries[i];
+		long long sum = 0;
+		long long games = 0;
+		size_t j = i;
+		for (; j < list->count && list->entries[j].key == merged.key && list->entries[j].move == merged.move; j++) {
+			BookEntry* e = &list->entries[j];
+			if (e->depth > 0) {
+				if (e->depth >= merged.depth) {
+					merged.score = e->score;
+					merged.depth = e->depth;
+				}
+			}
+			else {
+				sum += (long long)e->score * e->count;
+				games += e->count;
+			}
+		}
+		merged.count = (uint32_t)games;
+		if (merged.depth == 0 && games > 0) merged.score = (int16_t)(sum / games);
+		if (merged.depth > 0 || games >= minGames) list->entries[n++] = merged;
+		i = j;
+	}
+	list->count = n;
+}
+
+//@@***********************************************************************************@@
+// add every position up to plies moves away from p that has a move, return 0 when out of memory
+int collectPositions(Position* p, int plies, BookPosition** list, int* n, int* size) {
+	uint64_t moves = getMoves(p->board.player, p->board.opponent);
+	Undo u;
+
+	if (!moves) return 1;
+	if (*n == *size) {
+		*size = *size ? 2 * *size : 1024;
+		BookPosition* grown = (BookPosition*)realloc(*list, *size * sizeof(BookPosition));
+		if (!grown) return 0;
+		*list = grown;
+	}
+	int symmetries;
+	BookPosition* bp = &(*list)[(*n)++];
+	bp->key = canonicalKey(p->board.player, p->board.opponent, &symmetries);
+	bp->player = p->board.player;
+	bp->opponent = p->board.opponent;
+	bp->identity = p->identity;
+
+	if (plies == 0) return 1;
+	for (; moves; moves &= moves - 1) {
+		makeMove(p, lowestBit(moves), &u);
+		int ok = collectPositions(p, plies - 1, list, n, size);
+		undoMove(p, &u);
+		if (!ok) return 0;
+	}
+	return 1;
+}
+
+//@@***********************************************************************************@@
+// order of the positions to search, by key
+int comparePositions(const void* a, const void* b) {
+	const BookPosition* x = (const BookPosition*)a;
+	const BookPosition* y = (const BookPosition*)b;
+	return x->key < y->key ? -1 : (x->key > y->key ? 1 : 0);
+}
+
+//@@***********************************************************************************@@
+// search the position after every move and add the move with the score seen from the side that played
+// it. Equal moves of a symmetric position are searched once
+void searchMoves(EntryList* list, BookPosition* bp, SearchLimits* limits) {
+	Position p;
+	int symmetries;
+	int done = 0;
+
+	setPosition(&p, bp->identity == 0 ? bp->player : bp->opponent, bp->identity == 0 ? bp->opponent : bp->player, bp->identity);
+	canonicalKey(p.board.player, p.board.opponent, &symmetries);
+	for (uint64_t moves = getMoves(p.board.player, p.board.opponent); moves; moves &= moves - 1) {
+		int x = lowestBit(moves);
+		int move = canonicalMove(x, symmetries);
+		int repeated = 0;
+		for (int i = 0; i < done; i++) repeated |= list->entries[list->count - 1 - i].move == move;
+		if (repeated) continue;
+
+		Position child = p;
+		Undo u;
+		SearchResult result;
+		int score, depth, sign = -1;
+		makeMove(&child, x, &u);
+		uint64_t black = child.identity == 0 ? child.board.player : child.board.opponent;
+		uint64_t white = child.identity == 0 ? child.board.opponent : child.board.player;
+		setPosition(&child, black, white, child.identity);				// the path value of the move does not count
+		if (!getMoves(child.board.player, child.board.opponent)) {
+			if (!getMoves(child.board.opponent, child.board.player)) {
+				// the move ends the game
+				addEntry(list, bp->key, move, finalScore(child.board.opponent, child.board.player) * BOOK_UNIT, BOARD_SIZE * BOARD_SIZE, 0);
+				done++;
+				continue;
+			}
+			makePass(&child);											// the same side moves again
+			sign = 1;
+		}
+		searchPosition(&child, limits, &result);
+		if (result.exact) score = result.score * BOOK_UNIT;
+		else score = result.score * BOOK_UNIT / evaluationUnit();
+		depth = result.exact ? BOARD_SIZE * BOARD_SIZE : result.depth + 1;
+		if (depth > 255) depth = 255;
+		if (score > 32767) score = 32767;
+		if (score < -32767) score = -32767;
+		if (!addEntry(list, bp->key, move, sign * score, depth, 0)) return;
+		done++;
+	}
+}
@@ -0,0 +1,131 @@
+/*
+*** FILE NAME   : othello_cli.c
+*** PURPOSE		: Headless front-end of the Othello ai, searches positions without openGL
+*** DESCRIPTION : Each line of the input holds one position: 64 characters for the board (row by row,
+				  X, B or * for black, O or W for white, - or . for an empty block), a space and the
+				  side to move (X/B for black, O/W for white). Lines that start with # and blank lines
+				  are skipped. The positions are read from the file given as the last argument or from
+				  the standard input. For every position the best move, its score, the depth, the
+				  nodes and the time are printed, and a summary with the nodes per second is printed
+				  on the standard error at the end.
+				  Options: -time <ms>, -depth <max depth>, -threads <n>, -hash <MB>, -endgame <empties>,
+				  -json (print the result and the search statistics of every position as a JSON line),
+				  -eval <file> (weights of the pattern evaluation, PATTERN_FILE is tried when it is not given),
+				  -book <file> (opening book, BOOK_FILE is tried when it is not given), -nobook,
+				  -cache <file> (reuse and keep the deep and exact searches in the file),
+				  -probcut <file> (multi-probcut parameters, PROBCUT_FILE is tried when it is not given),
+				  -selectivity <sigmas> (0 turns multi-probcut off), -size <n> (the positions are of the
+				  6x6, 8x8 or 10x10 board, n * n characters each; the sizes other than 8 are searched by
+				  their own kernels without the table, the weights, the book and the cache)
+*/
+
+#include <stdio.h>						// standard C libraries
+#include <stdlib.h>
+#include <string.h>
+#include "othello_engine.h"				// rules and search of the ai
+
+
+//@@***********************************************************************************@@
+// Constants
+#define LINE_SIZE 256					// longest input line
+
+
+//@@***********************************************************************************@@
+int main(int argc, char **argv)
+{
+	// optional arguments: -time <ms>, -depth <max depth>, -threads <n>, -hash <MB>, -endgame <empties>, -json, -eval <file>,
+	// -book <file>, -nobook, -cache <file>, -probcut <file>, -selectivity <sigmas>, -size <n>, [file]
+	SearchLimits limits;
+	int hashMB = HASH_MB;
+	char* evalFile = NULL;
+	char* probcutFile = NULL;
+	char* bookFile = NULL;
+	int useBook = 1;
+	char* cacheFile = NULL;
+	int json = 0;
+	char* fileName = NULL;
+	int size = BOARD_SIZE;
+	defaultLimits(&limits);
+	for (int i = 1; i < argc; i++) {
+		if (argv[i][0] != '-') fileName = argv[i];
+		else if (strcmp(argv[i], "-json") == 0) json = 1;
+		else if (strcmp(argv[i], "-nobook") == 0) useBook = 0;
+		else if (i + 1 >= argc) break;
+		else if (strcmp(argv[i], "-hash") == 0) hashMB = atoi(argv[++i]);
+		else if (strcmp(argv[i], "-time") == 0) limits.msec = atoi(argv[++i]);
+		else if (strcmp(argv[i], "-depth") == 0) limits.maxDepth = atoi(argv[++i]);
+		else if (strcmp(argv[i], "-threads") == 0) limits.threads = atoi(argv[++i]);
+		else if (strcmp(argv[i], "-endgame") == 0) limits.endgameEmpties = atoi(argv[++i]);
+		else if (strcmp(argv[i], "-eval") == 0) evalFile = argv[++i];
+		else if (strcmp(argv[i], "-probcut") == 0) probcutFile = argv[++i];
+		else if (strcmp(argv[i], "-selectivity") == 0) limits.probcut = atof(argv[++i]);
+		else if (strcmp(argv[i], "-book") == 0) bookFile = argv[++i];
+		else if (strcmp(argv[i], "-cache") == 0) cacheFile = argv[++i];
+		else if (strcmp(argv[i], "-size") == 0) size = atoi(argv[++i]);
+	}
+	const SizeKernels* kernels = sizeSelect(size);
+	if (!kernels) {
+		fprintf(stderr, "The board size %d is not supported, use 6, 8 or 10.\n", size);
+		return 1;
+	}
+	if (!engineInit(hashMB)) {
+		fprintf(stderr, "Cannot allocate %d MB for the transposition table.\n", hashMB);
+		return 1;
+	}
+	if (!evalFile) patternLoad(PATTERN_FILE);					// the default weights are optional
+	else if (!patternLoad(evalFile)) {
+		fprintf(stderr, "Cannot load the weights from %s.\n", evalFile);
+		return 1;
+	}
+	if (!probcutFile) probcutLoad(PROBCUT_FILE);				// the default parameters are optional
+	else if (!probcutLoad(probcutFile)) {
+		fprintf(stderr, "Cannot load the multi-probcut parameters from %s, or they were fitted with another evaluation.\n", probcutFile);
+		return 1;
+	}
+	if (useBook && !bookFile) bookOpen(BOOK_FILE);				// the default book is optional
+	else if (useBook && !bookOpen(bookFile)) {
+		fprintf(stderr, "Cannot open the book %s.\n", bookFile);
+		return 1;
+	}
+	if (cacheFile && !cacheOpen(cacheFile)) {
+		fprintf(stderr, "Cannot open the cache %s, or it was made with another evaluation.\n", cacheFile);
+		return 1;
+	}
+
+	FILE* in = stdin;
+	if (fileName && !(in = fopen(fileName, "r"))) {
+		fprintf(stderr, "Cannot open %s.\n", fileName);
+		return 1;
+	}
+
+	// search every position of the input
+	char line[LINE_SIZE];
+	char name[16];
+	int count = 0;
+	long long nodes = 0;
+	long long msec = 0;
+	while (fgets(line, sizeof(line), in)) {
+		WideMask black, white;
+		int identity;
+		int found = readBoardLine(line, size, &black, &white, &identity);
+		if (found < 0) fprintf(stderr, "Skipped a line that is not a position: %s", line);
+		if (found <= 0) continue;
+
+		SearchResult result;
+		kernels->search(black, white, identity, &limits, &result);
+		sizeMoveName(size, result.move, name);
+		count++;
+		if (json) writeSearchJson(stdout, &result);
+		else {
+			printf("%d move %s score %d depth %d%s%s nodes %lld msec %lld\n", count, name, result.score,
+				result.depth, result.exact ? " exact" : (result.book ? " book" : ""), result.cached ? " cached" : "", result.nodes, result.msec);
+			fflush(stdout);
+		}
+		nodes += result.nodes;
+		msec += result.msec;
+	}
+	if (in != stdin) fclose(in);
+
+	fprintf(stderr, "positions %d nodes %lld msec %lld nps %lld\n", count, nodes, msec, msec > 0 ? nodes * 1000 / msec : 0);
+	return 0;
+}
@@ -0,0 +1,2337 @@
+/*
+*** FILE NAME   : othello_engine.c
+*** PURPOSE		: Rules and alpha-beta search of the Othello ai, without any openGL dependency
+*** DESCRIPTION : See othello_engine.h. The threads of a search share the zobrist keys and the
+				  transposition table below, everything else a search changes lives in its
+				  SearchContext.
+*/
+
+#include <stdio.h>						// standard C libraries
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <threads.h>
+#include <fcntl.h>						// POSIX libraries to map the opening book
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "othello_engine.h"
+#if defined(__GNUC__) && defined(__x86_64__)
+#include <immintrin.h>					// the AVX2 and AVX-512 kernels are compiled and cpuid picks one at startup
+#define SIMD_X86 1
+#else
+#define SIMD_X86 0
+#endif
+
+
+//@@***********************************************************************************@@
+// Global variables
+
+uint64_t zobristDisc[2][BOARD_SIZE * BOARD_SIZE];	// random key for each circle, [0]: black circles, [1]: white circles
+uint64_t zobristFlip[BOARD_SIZE * BOARD_SIZE];		// key change when the circle on a block is flipped
+uint64_t zobristSide;					// key for white to move
+
+HashBucket* hashTable;					// transposition table, aligned to the cache line
+uint64_t hashMask;						// number of buckets - 1
+uint8_t hashAge;						// current search generation
+
+// the four quadrants of the board, the solver plays first in the quadrants with an odd number of empties
+const uint64_t quadrantMask[4] = { 0x000000000F0F0F0FULL, 0x00000000F0F0F0F0ULL, 0x0F0F0F0F00000000ULL, 0xF0F0F0F000000000ULL };
+
+// shift and wrap mask for each direction (0: up, 1: right up, 2: right, 3: right down, 4: down, 5: left down, 6: left, 7: left up)
+const int dirShift[8] = { -8, -7, 1, 9, 8, 7, -1, -9 };
+const uint64_t dirMask[8] = {
+	0xFFFFFFFFFFFFFFFFULL, 0xFEFEFEFEFEFEFEFEULL, 0xFEFEFEFEFEFEFEFEULL, 0xFEFEFEFEFEFEFEFEULL,
+	0xFFFFFFFFFFFFFFFFULL, 0x7F7F7F7F7F7F7F7FULL, 0x7F7F7F7F7F7F7F7FULL, 0x7F7F7F7F7F7F7F7FULL
+};
+
+int moveValue[BOARD_SIZE * BOARD_SIZE];	// getMoveValue of every block
+uint64_t neighbourMask[BOARD_SIZE * BOARD_SIZE];	// the blocks around every block
+
+// blocks of the first pattern of every kind (the length first), the other patterns of a kind are its
+// rotations and mirrors and list their blocks in the same order so they share the weights
+const int patternShape[PATTERN_TYPES][11] = {
+	{ 10, 9, 0, 1, 2, 3, 4, 5, 6, 7, 14 },						// edge + 2X
+	{ 9, 0, 1, 2, 8, 9, 10, 16, 17, 18 },						// corner 3x3
+	{ 10, 0, 1, 2, 3, 4, 8, 9, 10, 11, 12 },					// corner 2x5
+	{ 8, 0, 9, 18, 27, 36, 45, 54, 63 },						// diagonal of 8
+	{ 7, 1, 10, 19, 28, 37, 46, 55 },							// diagonal of 7
+	{ 6, 2, 11, 20, 29, 38, 47 },								// diagonal of 6
+	{ 5, 3, 12, 21, 30, 39 },									// diagonal of 5
+	{ 4, 4, 13, 22, 31 },										// diagonal of 4
+	{ 8, 8, 9, 10, 11, 12, 13, 14, 15 },						// second line
+	{ 8, 16, 17, 18, 19, 20, 21, 22, 23 },						// third line
+	{ 8, 24, 25, 26, 27, 28, 29, 30, 31 }						// fourth line
+};
+int patternBlocks[PATTERN_COUNT][10];	// blocks of every pattern
+int patternLength[PATTERN_COUNT];		// number of blocks of every pattern
+int patternOffset[PATTERN_COUNT];		// where the weights of the pattern's kind start in a phase
+int patternPhaseSize;					// number of weights of one phase
+int blockPatterns[BOARD_SIZE * BOARD_SIZE];			// number of patterns that a block belongs to
+int blockPattern[BOARD_SIZE * BOARD_SIZE][12];		// the patterns of every block
+int blockPower[BOARD_SIZE * BOARD_SIZE][12];		// the power of 3 of the block in each of its patterns
+int16_t* patternWeights;				// PATTERN_PHASES * patternPhaseSize weights, NULL when the pattern evaluation is off
+
+// weights of the features of the evaluation without patterns in every phase, in the points of a circle:
+// mobility, potential mobility, frontier circles, stable circles and odd regions
+const int featureWeight[FEATURE_PHASES][FEATURE_COUNT] = {
+	{ 12, 6, 5, 30, 0 },
+	{ 10, 5, 4, 40, 5 },
+	{ 6, 3, 2, 40, 15 }
+};
+uint8_t edgeStable[256][256];			// the stable circles of the player on an edge, [player][opponent] as 8 bits
+uint64_t edgeColumn[256];				// 8 bits spread on the first column, bit r in row r
+uint64_t diagonalMask[2][15];			// the diagonals along direction 3 (right down) and 5 (left down)
+
+ProbcutPair* probcutTable;				// PROBCUT_PHASES * PROBCUT_DEPTHS * PROBCUT_DEPTHS pairs, NULL when multi-probcut is off
+
+void* bookMap;							// the mapped book file, NULL when no book is open
+size_t bookMapSize;						// size of the mapping in bytes
+const BookEntry* bookEntries;			// the sorted entries inside the mapping
+size_t bookCount;						// number of entries
+
+void* cacheMap;							// the search cache file as it was when it was opened, NULL when no cache is open
+size_t cacheMapSize;					// size of the mapping in bytes
+const CacheEntry* cacheMapped;			// the entries inside the mapping
+size_t cacheMappedCount;				// number of mapped entries
+CacheEntry* cacheAdded;					// the entries found since the file was opened
+size_t cacheAddedCount;					// number of added entries
+size_t cacheAddedSize;					// room for added entries
+uint32_t* cacheIndex;					// open addressing table of the best entry of every key, entry number + 1, 0 when empty
+size_t cacheIndexMask;					// size of the index - 1
+FILE* cacheOut;							// the cache file opened for appending
+mtx_t cacheLock;						// guards the cache, searches of several callers can use it at once
+int cacheLockReady;						// 1 when cacheLock is initialized
+
+//@@***********************************************************************************@@
+// Function
+
+void initZobrist();											// generate the zobrist keys
+uint64_t shiftBits(uint64_t x, int d);						// shift the bits towards direction d (0 - 7)
+
+// move and flip kernels, simdSelect points getMoves and getFlips at the fastest one the cpu supports
+uint64_t getMovesScalar(uint64_t p, uint64_t o);			// valid moves, one direction after the other
+uint64_t getFlipsScalar(uint64_t p, uint64_t o, int x);		// flipped circles, one direction after the other
+#if SIMD_X86
+uint64_t getMovesAvx2(uint64_t p, uint64_t o);				// valid moves, 4 directions at once
+uint64_t getFlipsAvx2(uint64_t p, uint64_t o, int x);		// flipped circles, 4 directions at once
+uint64_t getMovesAvx512(uint64_t p, uint64_t o);			// valid moves, all 8 directions at once
+uint64_t getFlipsAvx512(uint64_t p, uint64_t o, int x);		// flipped circles, all 8 directions at once
+#endif
+uint64_t (*movesKernel)(uint64_t p, uint64_t o) = getMovesScalar;			// the kernel of getMoves
+uint64_t (*flipsKernel)(uint64_t p, uint64_t o, int x) = getFlipsScalar;	// the kernel of getFlips
+int simdLevel = SIMD_SCALAR;								// level of the selected kernels
+
+// search functions, each search thread works on its own context
+int searchThread(void* arg);								// thread entry of a helper thread
+void iterativeDeepening(SearchContext* ctx);				// deepen the search of a thread until it has to stop
+int timeUp(SearchContext* ctx);								// check the time budget every few nodes
+int stopCheck(SearchContext* ctx, int check);				// stop the search when cancelled or out of time, the flag and the clock are read if check is set
+int analyzeRoot(SearchContext* ctx, MoveAnalysis list[], int n, int k, int solve);	// score the root moves at the current depth, return 0 if stopped
+void analysisFill(Position* root, SearchContext* ctx, int k, long long start, Analysis* a);	// copy the last finished iteration into the analysis
+int pvSearch(SearchContext* ctx, int alpha, int beta, int h);	// negamax alpha-beta search with principal variation windows
+int probcut(SearchContext* ctx, int alpha, int beta, int h, int* score);	// try to prove the node outside the window with shallow searches, return 1 if it is
+int expendNode(SearchContext* ctx, int moves[], int hashMove, int h);	// list the children moves of a position in search order, return # of children
+void updateOrdering(SearchContext* ctx, int move, int h);	// record a move that caused a cutoff in the killer and history tables
+
+// endgame solver functions, the scores are the final circle differences seen from the side to move
+int solveRoot(SearchContext* ctx);							// solve the root position exactly, return 0 if it ran out of time
+int solveEndgame(SearchContext* ctx, uint64_t p, uint64_t o, int alpha, int beta, int parity, int h);	// exact search with principal variation windows
+int solveLast4(SearchContext* ctx, uint64_t p, uint64_t o, int alpha, int beta, int parity);			// exact search of the last 4 empties
+int solveLast3(SearchContext* ctx, uint64_t p, uint64_t o, int alpha, int beta, int x1, int x2, int x3);	// exact search of the last 3 empties
+int solveLast2(SearchContext* ctx, uint64_t p, uint64_t o, int alpha, int beta, int x1, int x2);		// exact search of the last 2 empties
+int solveLast1(SearchContext* ctx, uint64_t p, uint64_t o, int x);	// final score of the last empty
+uint64_t hashBits(uint64_t p, uint64_t o);					// transposition key of an endgame position
+int principalVariation(Position* root, int move, int exact, int maxLength, int pv[]);	// follow the best moves of the table, return the length
+int quadrantOf(int x);										// quadrant (0 - 3) of a block
+
+// search cache functions
+const CacheEntry* cacheEntryAt(size_t n);					// the entry number n, mapped or added
+int cacheInsert(size_t n);									// put an entry in the index if it is the best of its key, return 0 when out of memory
+uint64_t cacheKey(Position* p, int* symmetries);			// canonicalKey of the board with the side to move
+uint64_t evaluationId();									// checksum of the evaluation that the cached scores belong to
+
+// feature evaluation functions, every feature is counted from the side to move
+void featureInit();											// build the edge stability table and the line masks
+int edgeStability(int p, int o, int stable);				// the candidates in stable that no moves on the edge can flip, as 8 bits
+int edgeFlips(int p, int o, int x);							// the circles of o on an edge flipped when p moves at x
+uint64_t stableCircles(uint64_t p, uint64_t o);				// circles of p that can never be flipped: stable on an edge or on 4 full lines
+uint64_t fullLines(uint64_t occupied);						// the blocks whose row, column and both diagonals are full
+int featureEvaluate(Position* p);							// weighted sum of the features for the side to move
+
+// board size functions, othello_size.h generates the kernels of every size
+void sizeInit();											// fill the square values of every board size
+int sizeSearchEngine(WideMask black, WideMask white, int identity, SearchLimits* limits, SearchResult* result);	// searchPosition as the search of the 8x8 kernels
+void sizeUpdateOrdering(SizeSearch* s, int move, int depth, int h);	// updateOrdering of the search of a board size
+
+// pattern evaluation functions
+void patternInit();											// list the patterns and the patterns of every block
+void patternAdd(Position* p, int x, int digit);				// add digit times the power of x to every pattern of the block x
+int patternEvaluate(Position* p);							// sum of the pattern weights seen from the side to move
+
+//@@***********************************************************************************@@
+// set up the zobrist keys, the fastest move kernels of the cpu and the transposition table
+int engineInit(int hashMB) {
+	initZobrist();
+	patternInit();
+	featureInit();
+	simdSelect(SIMD_AVX512);
+	sizeInit();
+	for (int x = 0; x < BOARD_SIZE * BOARD_SIZE; x++) {
+		moveValue[x] = getMoveValue(x / BOARD_SIZE, x % BOARD_SIZE);
+		neighbourMask[x] = getNeighbours(1ULL << x);
+	}
+	return hashInit(hashMB);
+}
+
+//@@***********************************************************************************@@
+// the default limits of a search
+void defaultLimits(SearchLimits* limits) {
+	limits->msec = SEARCH_MSEC;
+	limits->maxDepth = ALPHABETAHEIGHT;
+	limits->threads = 1;
+	limits->endgameEmpties = ENDGAME_EMPTIES;
+	limits->probcut = PROBCUT_T;
+	limits->cancel = NULL;
+	limits->ponder = 0;
+}
+
+//@@***********************************************************************************@@
+// set up a position from the black and white circles
+void setPosition(Position* p, uint64_t black, uint64_t white, int identity) {
+	p->board.player = identity == 0 ? black : white;
+	p->board.opponent = identity == 0 ? white : black;
+	p->value = 0;
+	p->whiteNum = popCount(white);
+	p->blackNum = popCount(black);
+	p->identity = identity;
+	p->hash = hashPosition(p);
+	p->frontier = getNeighbours(black | white) & ~(black | white);
+	if (patternWeights) patternIndex(black, white, p->pattern);
+}
+
+//@@***********************************************************************************@@
+// set up the start position: white on the diagonal of the 4 middle blocks, black on the other diagonal
+void startPosition(Position* p, int identity) {
+	int m = BOARD_SIZE / 2;
+	uint64_t black = (1ULL << ((m - 1) * BOARD_SIZE + m)) | (1ULL << (m * BOARD_SIZE + m - 1));
+	uint64_t white = (1ULL << ((m - 1) * BOARD_SIZE + m - 1)) | (1ULL << (m * BOARD_SIZE + m));
+	setPosition(p, black, white, identity);
+}
+
+//@@***********************************************************************************@@
+// search the best move of a position. The threads search the same root on their own context and share
+// what they find through the transposition table (lazy SMP), the deepest finished iteration gives the move
+int searchPosition(Position* root, SearchLimits* limits, SearchResult* result) {
+	int threadNum = limits->threads < 1 ? 1 : (limits->threads > MAX_THREADS ? MAX_THREADS : limits->threads);
+	memset(result, 0, sizeof(SearchResult));
+	result->move = -1;
+	if (!getMoves(root->board.player, root->board.opponent)) return -1;	// no children
+
+	if (bookMap) {
+		// a book move is played without searching
+		int score;
+		int move = bookProbe(root, &score);
+		if (move >= 0) {
+			result->move = move;
+			result->score = score * evaluationUnit() / BOOK_UNIT;
+			result->book = 1;
+			result->pv[0] = move;
+			result->pvLength = 1;
+			return move;
+		}
+	}
+
+	if (cacheOut && cacheProbe(root, limits, result)) return result->move;	// searched as well before
+
+	if (!limits->ponder) hashAge++;										// entries of the previous moves get replaced first, pondering keeps them
+
+	SearchShared shared;
+	shared.start = currentMsec();
+	shared.msec = limits->msec;
+	shared.maxDepth = limits->maxDepth;
+	shared.endgameEmpties = limits->endgameEmpties;
+	shared.probcut = probcutTable ? limits->probcut : 0;
+	shared.cancel = limits->cancel;
+	atomic_init(&shared.stop, 0);
+
+	SearchContext* ctx = (SearchContext*)calloc(threadNum, sizeof(SearchContext));
+	thrd_t* threads = (thrd_t*)malloc(threadNum * sizeof(thrd_t));
+	if (!ctx || !threads) {
+		free(ctx);
+		free(threads);
+		return -1;
+	}
+	for (int i = 0; i < threadNum; i++) {
+		ctx[i].id = i;
+		ctx[i].shared = &shared;
+		ctx[i].pos = *root;
+		ctx[i].bestMove = -1;
+		memset(ctx[i].killerMove, -1, sizeof(ctx[i].killerMove));
+	}
+
+	// start the helpers, the main thread searches on the caller and stops the helpers when it is done
+	int helpers = 1;
+	for (; helpers < threadNum; helpers++) {
+		if (thrd_create(&threads[helpers], searchThread, &ctx[helpers]) != thrd_success) break;
+	}
+	iterativeDeepening(&ctx[0]);
+	atomic_store(&shared.stop, 1);
+	for (int i = 1; i < helpers; i++) thrd_join(threads[i], NULL);
+
+	// the deepest finished iteration gives the move, an exact solve beats any midgame depth
+	SearchContext* best = &ctx[0];
+	for (int i = 0; i < helpers; i++) {
+		if (ctx[i].bestMove != -1 && (ctx[i].exact > best->exact ||
+			(ctx[i].exact == best->exact && ctx[i].completedDepth > best->completedDepth))) best = &ctx[i];
+		result->nodes += ctx[i].nodes;
+		result->counters.researches += ctx[i].counters.researches;
+		result->counters.failHighs += ctx[i].counters.failHighs;
+		result->counters.failLows += ctx[i].counters.failLows;
+		for (int d = 0; d < STATS_PLY; d++) result->stats.plyNodes[d] += ctx[i].stats.plyNodes[d];
+		for (int c = 0; c < STATS_CUT; c++) result->stats.cutIndex[c] += ctx[i].stats.cutIndex[c];
+		result->stats.evals += ctx[i].stats.evals;
+		result->stats.cutoffs += ctx[i].stats.cutoffs;
+		result->stats.hashProbes += ctx[i].stats.hashProbes;
+		result->stats.hashHits += ctx[i].stats.hashHits;
+	}
+	result->move = best->bestMove;
+	result->score = best->score;
+	result->depth = best->completedDepth;
+	result->exact = best->exact;
+	result->threads = helpers;
+	result->msec = currentMsec() - shared.start;
+
+	// the iterations of the main thread give the time per depth and the branching factor
+	int last = ctx[0].stats.iterations;
+	result->stats.iterations = last;
+	memcpy(result->stats.iterNodes, ctx[0].stats.iterNodes, sizeof(result->stats.iterNodes));
+	memcpy(result->stats.iterMsec, ctx[0].stats.iterMsec, sizeof(result->stats.iterMsec));
+	memcpy(result->stats.iterScore, ctx[0].stats.iterScore, sizeof(result->stats.iterScore));
+	if (last >= 3) {
+		result->branching = (double)(ctx[0].stats.iterNodes[last] - ctx[0].stats.iterNodes[last - 1]) /
+			(ctx[0].stats.iterNodes[last - 1] - ctx[0].stats.iterNodes[last - 2] + 1);
+	}
+	result->pvLength = principalVariation(root, result->move, result->exact, result->depth, result->pv);
+	free(ctx);
+	free(threads);
+	if (cacheOut && !(limits->cancel && atomic_load(limits->cancel))) cacheStore(root, limits, result);
+
+	// return the position for the next move
+	return result->move;
+}
+
+//@@***********************************************************************************@@
+// get the evaluated value from a specific block when a move is made
+int getMoveValue(int r, int c) {
+	return sizeMoveValue(BOARD_SIZE, r, c);
+}
+
+//@@***********************************************************************************@@
+// the value of a block of a board of that size, the rings are counted from the edges so every size gets
+// its corners, edges and the blocks next to them
+int sizeMoveValue(int size, int r, int c) {
+	const int last = size - 1;
+	int rowEdge = r == 0 || r == last;								// on the top or bottom edge
+	int colEdge = c == 0 || c == last;
+	int rowInner = r == 1 || r == last - 1;						// on the ring inside the edges
+	int colInner = c == 1 || c == last - 1;
+
+	// in the center area, 2 blocks or more away from every edge
+	if (!rowEdge && !colEdge && !rowInner && !colInner) return 0;
+	// outer corners
+	else if (rowEdge && colEdge) return 70;
+	// inner corners
+	else if (rowInner && colInner) return -50;
+	// inner four sides and the blocks next to the four corners
+	else if (rowInner || colInner) return -30;
+	// outer four sides
+	else return 50;
+}
+
+//@@***********************************************************************************@@
+// shift the bits towards a direction, the wrapped bits are masked out
+uint64_t shiftBits(uint64_t x, int d) {
+	if (dirShift[d] > 0) return (x << dirShift[d]) & dirMask[d];
+	else return (x >> -dirShift[d]) & dirMask[d];
+}
+
+//@@***********************************************************************************@@
+// generate all the valid moves of p against o with the kernel of the cpu
+uint64_t getMoves(uint64_t p, uint64_t o) {
+	return movesKernel(p, o);
+}
+
+//@@***********************************************************************************@@
+// get the circles of o that will be flipped when p moves at x with the kernel of the cpu
+uint64_t getFlips(uint64_t p, uint64_t o, int x) {
+	return flipsKernel(p, o, x);
+}
+
+//@@***********************************************************************************@@
+// get the blocks next to the blocks of b in the 8 directions
+uint64_t getNeighbours(uint64_t b) {
+	uint64_t side = ((b << 1) & 0xFEFEFEFEFEFEFEFEULL) | ((b >> 1) & 0x7F7F7F7F7F7F7F7FULL);
+	uint64_t row = b | side;											// the row above and below see the circles and their sides
+	return side | (row << 8) | (row >> 8);
+}
+
+//@@***********************************************************************************@@
+// use the fastest move and flip kernels up to the level that the cpu supports (checked with cpuid),
+// return the level chosen
+int simdSelect(int level) {
+	movesKernel = getMovesScalar;
+	flipsKernel = getFlipsScalar;
+	simdLevel = SIMD_SCALAR;
+#if SIMD_X86
+	__builtin_cpu_init();
+	if (level >= SIMD_AVX512 && __builtin_cpu_supports("avx512f")) {
+		movesKernel = getMovesAvx512;
+		flipsKernel = getFlipsAvx512;
+		simdLevel = SIMD_AVX512;
+	}
+	else if (level >= SIMD_AVX2 && __builtin_cpu_supports("avx2")) {
+		movesKernel = getMovesAvx2;
+		flipsKernel = getFlipsAvx2;
+		simdLevel = SIMD_AVX2;
+	}
+#endif
+	return simdLevel;
+}
+
+//@@***********************************************************************************@@
+// generate all the valid moves of p against o one direction after the other
+uint64_t getMovesScalar(uint64_t p, uint64_t o) {
+	uint64_t empty = ~(p | o);
+	uint64_t moves = 0;
+
+	for (int d = 0; d < 8; d++) {
+		uint64_t t = shiftBits(p, d) & o;									// opponent circles next to the player's circles
+		t |= shiftBits(t, d) & o;											// a line holds at most 6 circles in between
+		t |= shiftBits(t, d) & o;
+		t |= shiftBits(t, d) & o;
+		t |= shiftBits(t, d) & o;
+		t |= shiftBits(t, d) & o;
+		moves |= shiftBits(t, d) & empty;									// the empty block that closes the line
+	}
+	return moves;
+}
+
+//@@***********************************************************************************@@
+// get the circles of o that will be flipped when p moves at x, walking one direction after the other
+uint64_t getFlipsScalar(uint64_t p, uint64_t o, int x) {
+	uint64_t flips = 0;
+	uint64_t m = 1ULL << x;
+
+	for (int d = 0; d < 8; d++) {
+		uint64_t f = 0;
+		uint64_t t = shiftBits(m, d);
+		while (t & o) {														// walk through the opponent circles
+			f |= t;
+			t = shiftBits(t, d);
+		}
+		if (t & p) flips |= f;												// closed by the player's circle
+	}
+	return flips;
+}
+
+#if SIMD_X86
+//@@***********************************************************************************@@
+// generate the valid moves with AVX2: the lanes hold the directions 1, 8, 9 and 7, shifted left and
+// then right, and the opponent circles that a line can pass are masked so no shift wraps around
+__attribute__((target("avx2"))) uint64_t getMovesAvx2(uint64_t p, uint64_t o) {
+	const __m256i shift = _mm256_set_epi64x(7, 9, 8, 1);
+	const __m256i inner = _mm256_set_epi64x(0x007E7E7E7E7E7E00ULL, 0x007E7E7E7E7E7E00ULL, 0x00FFFFFFFFFFFF00ULL, 0x7E7E7E7E7E7E7E7EULL);
+	__m256i pp = _mm256_set1_epi64x(p);
+	__m256i oo = _mm256_and_si256(_mm256_set1_epi64x(o), inner);
+	__m256i l = _mm256_and_si256(oo, _mm256_sllv_epi64(pp, shift));
+	__m256i r = _mm256_and_si256(oo, _mm256_srlv_epi64(pp, shift));
+	for (int i = 0; i < 5; i++) {										// a line holds at most 6 circles in between
+		l = _mm256_or_si256(l, _mm256_and_si256(oo, _mm256_sllv_epi64(l, shift)));
+		r = _mm256_or_si256(r, _mm256_and_si256(oo, _mm256_srlv_epi64(r, shift)));
+	}
+	__m256i m = _mm256_or_si256(_mm256_sllv_epi64(l, shift), _mm256_srlv_epi64(r, shift));
+	__m128i h = _mm_or_si128(_mm256_castsi256_si128(m), _mm256_extracti128_si256(m, 1));
+	return (_mm_cvtsi128_si64(h) | _mm_cvtsi128_si64(_mm_unpackhi_epi64(h, h))) & ~(p | o);
+}
+
+//@@***********************************************************************************@@
+// get the flipped circles with AVX2: the line of opponent circles from x in each lane is kept when the
+// block after it holds a circle of p
+__attribute__((target("avx2"))) uint64_t getFlipsAvx2(uint64_t p, uint64_t o, int x) {
+	const __m256i shift = _mm256_set_epi64x(7, 9, 8, 1);
+	const __m256i inner = _mm256_set_epi64x(0x007E7E7E7E7E7E00ULL, 0x007E7E7E7E7E7E00ULL, 0x00FFFFFFFFFFFF00ULL, 0x7E7E7E7E7E7E7E7EULL);
+	const __m256i zero = _mm256_setzero_si256();
+	__m256i pp = _mm256_set1_epi64x(p);
+	__m256i oo = _mm256_and_si256(_mm256_set1_epi64x(o), inner);
+	__m256i mm = _mm256_set1_epi64x(1ULL << x);
+	__m256i l = _mm256_and_si256(oo, _mm256_sllv_epi64(mm, shift));
+	__m256i r = _mm256_and_si256(oo, _mm256_srlv_epi64(mm, shift));
+	for (int i = 0; i < 5; i++) {
+		l = _mm256_or_si256(l, _mm256_and_si256(oo, _mm256_sllv_epi64(l, shift)));
+		r = _mm256_or_si256(r, _mm256_and_si256(oo, _mm256_srlv_epi64(r, shift)));
+	}
+	l = _mm256_andnot_si256(_mm256_cmpeq_epi64(_mm256_and_si256(pp, _mm256_sllv_epi64(l, shift)), zero), l);	// closed lines only
+	r = _mm256_andnot_si256(_mm256_cmpeq_epi64(_mm256_and_si256(pp, _mm256_srlv_epi64(r, shift)), zero), r);
+	__m256i f = _mm256_or_si256(l, r);
+	__m128i h = _mm_or_si128(_mm256_castsi256_si128(f), _mm256_extracti128_si256(f, 1));
+	return _mm_cvtsi128_si64(h) | _mm_cvtsi128_si64(_mm_unpackhi_epi64(h, h));
+}
+
+//@@***********************************************************************************@@
+// generate the valid moves with AVX-512: all 8 directions in one register, a shift right by k is a
+// rotation left by 64 - k whose wrapped bits fall outside the masks of the inner circles
+__attribute__((target("avx512f"))) uint64_t getMovesAvx512(uint64_t p, uint64_t o) {
+	const __m512i rotate = _mm512_set_epi64(57, 55, 56, 63, 7, 9, 8, 1);
+	const __m512i inner = _mm512_set_epi64(0x007E7E7E7E7E7E00ULL, 0x007E7E7E7E7E7E00ULL, 0x00FFFFFFFFFFFF00ULL, 0x7E7E7E7E7E7E7E7EULL,
+		0x007E7E7E7E7E7E00ULL, 0x007E7E7E7E7E7E00ULL, 0x00FFFFFFFFFFFF00ULL, 0x7E7E7E7E7E7E7E7EULL);
+	__m512i oo = _mm512_and_si512(_mm512_set1_epi64(o), inner);
+	__m512i t = _mm512_and_si512(oo, _mm512_rolv_epi64(_mm512_set1_epi64(p), rotate));
+	for (int i = 0; i < 5; i++) t = _mm512_or_si512(t, _mm512_and_si512(oo, _mm512_rolv_epi64(t, rotate)));
+	return (uint64_t)_mm512_reduce_or_epi64(_mm512_rolv_epi64(t, rotate)) & ~(p | o);
+}
+
+//@@***********************************************************************************@@
+// get the flipped circles with AVX-512, the lines that a circle of p does not close are masked out
+__attribute__((target("avx512f"))) uint64_t getFlipsAvx512(uint64_t p, uint64_t o, int x) {
+	const __m512i rotate = _mm512_set_epi64(57, 55, 56, 63, 7, 9, 8, 1);
+	const __m512i inner = _mm512_set_epi64(0x007E7E7E7E7E7E00ULL, 0x007E7E7E7E7E7E00ULL, 0x00FFFFFFFFFFFF00ULL, 0x7E7E7E7E7E7E7E7EULL,
+		0x007E7E7E7E7E7E00ULL, 0x007E7E7E7E7E7E00ULL, 0x00FFFFFFFFFFFF00ULL, 0x7E7E7E7E7E7E7E7EULL);
+	__m512i oo = _mm512_and_si512(_mm512_set1_epi64(o), inner);
+	__m512i t = _mm512_and_si512(oo, _mm512_rolv_epi64(_mm512_set1_epi64(1ULL << x), rotate));
+	for (int i = 0; i < 5; i++) t = _mm512_or_si512(t, _mm512_and_si512(oo, _mm512_rolv_epi64(t, rotate)));
+	__mmask8 closed = _mm512_test_epi64_mask(_mm512_rolv_epi64(t, rotate), _mm512_set1_epi64(p));
+	return (uint64_t)_mm512_reduce_or_epi64(_mm512_maskz_mov_epi64(closed, t));
+}
+#endif
+
+//@@***********************************************************************************@@
+// count the bits of a mask
+int popCount(uint64_t x) {
+#if defined(__GNUC__)
+	return __builtin_popcountll(x);
+#else
+	int n = 0;
+	for (; x; x &= x - 1) n++;
+	return n;
+#endif
+}
+
+//@@***********************************************************************************@@
+// index of the lowest bit of a non-empty mask
+int lowestBit(uint64_t x) {
+#if defined(__GNUC__)
+	return __builtin_ctzll(x);
+#else
+	int n = 0;
+	while (!(x & 1)) {
+		x >>= 1;
+		n++;
+	}
+	return n;
+#endif
+}
+
+//@@***********************************************************************************@@
+// one of the 8 rotations and mirrors of a mask: bit 0 mirrors the columns, bit 1 mirrors the rows and
+// bit 2 swaps the rows with the columns (after the mirrors)
+uint64_t symmetryBits(uint64_t x, int s) {
+	uint64_t t;
+	if (s & 1) {
+		x = ((x >> 1) & 0x5555555555555555ULL) | ((x & 0x5555555555555555ULL) << 1);
+		x = ((x >> 2) & 0x3333333333333333ULL) | ((x & 0x3333333333333333ULL) << 2);
+		x = ((x >> 4) & 0x0F0F0F0F0F0F0F0FULL) | ((x & 0x0F0F0F0F0F0F0F0FULL) << 4);
+	}
+	if (s & 2) {
+		x = ((x >> 8) & 0x00FF00FF00FF00FFULL) | ((x & 0x00FF00FF00FF00FFULL) << 8);
+		x = ((x >> 16) & 0x0000FFFF0000FFFFULL) | ((x & 0x0000FFFF0000FFFFULL) << 16);
+		x = (x >> 32) | (x << 32);
+	}
+	if (s & 4) {
+		t = 0x0F0F0F0F00000000ULL & (x ^ (x << 28));
+		x ^= t ^ (t >> 28);
+		t = 0x3333000033330000ULL & (x ^ (x << 14));
+		x ^= t ^ (t >> 14);
+		t = 0x5500550055005500ULL & (x ^ (x << 7));
+		x ^= t ^ (t >> 7);
+	}
+	return x;
+}
+
+//@@***********************************************************************************@@
+// the block that x goes to under the same rotation or mirror as symmetryBits
+int symmetrySquare(int x, int s) {
+	int r = x / BOARD_SIZE;
+	int c = x % BOARD_SIZE;
+	if (s & 1) c = BOARD_SIZE - 1 - c;
+	if (s & 2) r = BOARD_SIZE - 1 - r;
+	if (s & 4) return c * BOARD_SIZE + r;
+	return r * BOARD_SIZE + c;
+}
+
+//@@***********************************************************************************@@
+// thread entry of a helper thread
+int searchThread(void* arg) {
+	iterativeDeepening((SearchContext*)arg);
+	return 0;
+}
+
+//@@***********************************************************************************@@
+// deepen the search until the time budget runs out, each iteration starts with the best moves of the
+// previous one from the transposition table. Every other helper starts one depth ahead so the threads
+// do not all search the same tree
+void iterativeDeepening(SearchContext* ctx) {
+	Position* p = &ctx->pos;
+	int empties = popCount(~(p->board.player | p->board.opponent));
+	for (ctx->depth = 1 + (ctx->id & 1); ctx->depth <= ctx->shared->maxDepth; ctx->depth++) {
+		if (ctx->id > 0 && atomic_load_explicit(&ctx->shared->stop, memory_order_relaxed)) break;
+
+		// search a small window around the previous score first, widen the side that fails
+		int window = ASPIRATION;
+		int alpha = ctx->completedDepth == 0 ? MIN : ctx->score - window;
+		int beta = ctx->completedDepth == 0 ? MAX : ctx->score + window;
+		int score = 0;
+		if (alpha < MIN) alpha = MIN;
+		if (beta > MAX) beta = MAX;
+		while (1) {
+			ctx->rootBest = -1;
+			int v = pvSearch(ctx, alpha, beta, 0);
+			if (ctx->abort) break;
+			window *= 2;
+			if (v <= alpha && alpha > MIN) {							// fail low
+				ctx->counters.failLows++;
+				alpha = v - window < MIN ? MIN : v - window;
+			}
+			else if (v >= beta && beta < MAX) {							// fail high
+				ctx->counters.failHighs++;
+				beta = v + window > MAX ? MAX : v + window;
+			}
+			else {
+				score = v;
+				break;
+			}
+		}
+		if (ctx->abort) break;											// keep the move of the last finished iteration
+		ctx->bestMove = ctx->rootBest;
+		ctx->score = score;
+		ctx->completedDepth = ctx->depth;
+		if (ctx->depth < STATS_PLY) {
+			ctx->stats.iterations = ctx->depth;
+			ctx->stats.iterNodes[ctx->depth] = ctx->nodes;
+			ctx->stats.iterMsec[ctx->depth] = currentMsec() - ctx->shared->start;
+			ctx->stats.iterScore[ctx->depth] = score;
+		}
+
+		// close to the end, solve the game exactly once a midgame move is ready
+		if (empties <= ctx->shared->endgameEmpties && (ctx->depth >= ENDGAME_PREDEPTH || ctx->depth >= empties)) {
+			solveRoot(ctx);
+			break;
+		}
+		if (ctx->depth >= empties) break;								// the whole game tree is searched
+		if (currentMsec() - ctx->shared->start >= ctx->shared->msec) break;
+	}
+}
+
+//@@***********************************************************************************@@
+// wall-clock time in ms
+long long currentMsec() {
+	struct timespec ts;
+	timespec_get(&ts, TIME_UTC);
+	return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+//@@***********************************************************************************@@
+// write the result and its statistics as one JSON line, the lists end at the last ply that has nodes
+void writeSearchJson(FILE* out, SearchResult* r) {
+	SearchStats* st = &r->stats;
+	int plies = STATS_PLY;
+	while (plies > 0 && st->plyNodes[plies - 1] == 0) plies--;
+
+	fprintf(out, "{\"move\":%d,\"score\":%d,\"depth\":%d,\"exact\":%d,\"book\":%d,\"cached\":%d,\"threads\":%d,\"nodes\":%lld,\"msec\":%lld,\"nps\":%lld",
+		r->move, r->score, r->depth, r->exact, r->book, r->cached, r->threads, r->nodes, r->msec, r->msec > 0 ? r->nodes * 1000 / r->msec : 0);
+	fprintf(out, ",\"evals\":%lld,\"cutoffs\":%lld,\"hashProbes\":%lld,\"hashHits\":%lld,\"branching\":%.2f",
+		st->evals, st->cutoffs, st->hashProbes, st->hashHits, r->branching);
+	fprintf(out, ",\"researches\":%d,\"failHighs\":%d,\"failLows\":%d",
+		r->counters.researches, r->counters.failHighs, r->counters.failLows);
+	fprintf(out, ",\"cutIndex\":[");
+	for (int i = 0; i < STATS_CUT; i++) fprintf(out, i ? ",%lld" : "%lld", st->cutIndex[i]);
+	fprintf(out, "],\"plyNodes\":[");
+	for (int i = 0; i < plies; i++) fprintf(out, i ? ",%lld" : "%lld", st->plyNodes[i]);
+	fprintf(out, "],\"iterations\":[");
+	for (int d = 1; d <= st->iterations; d++) {
+		fprintf(out, "%s{\"depth\":%d,\"score\":%d,\"nodes\":%lld,\"msec\":%lld}", d > 1 ? "," : "", d, st->iterScore[d], st->iterNodes[d], st->iterMsec[d]);
+	}
+	fprintf(out, "],\"pv\":[");
+	for (int i = 0; i < r->pvLength; i++) fprintf(out, i ? ",%d" : "%d", r->pv[i]);
+	fprintf(out, "]}\n");
+	fflush(out);
+}
+
+//@@***********************************************************************************@@
+// write an analysis as one JSON line: the index of the position, the depth, the nodes and time, then
+// the analysed moves with their score and principal variation (-1 is a pass)
+void writeAnalysisJson(FILE* out, int index, Analysis* a) {
+	fprintf(out, "{\"position\":%d,\"legal\":%d,\"depth\":%d,\"exact\":%d,\"nodes\":%lld,\"msec\":%lld,\"moves\":[",
+		index, a->legal, a->depth, a->exact, a->nodes, a->msec);
+	for (int i = 0; i < a->count; i++) {
+		MoveAnalysis* m = &a->moves[i];
+		fprintf(out, "%s{\"move\":%d,\"score\":%d,\"depth\":%d,\"pv\":[", i ? "," : "", m->move, m->score, m->depth);
+		for (int j = 0; j < m->pvLength; j++) fprintf(out, j ? ",%d" : "%d", m->pv[j]);
+		fprintf(out, "]}");
+	}
+	fprintf(out, "]}\n");
+}
+
+//@@***********************************************************************************@@
+// score the best multiPv moves of a position (all of them when multiPv is 0) with their depth and
+// principal variation, without the book or the cache. Every iteration searches the moves in the order
+// of the last one: the first multiPv with a full window, the others with a null window at the score of
+// the multiPv-th best move, and only those that beat it again with a full window. Several callers can
+// analyse positions at once on one thread each, they share the transposition table. When report is
+// given it gets the analysis of every finished iteration and of the exact solve with data
+int analyzePosition(Position* root, SearchLimits* limits, int multiPv, Analysis* a, AnalysisReport report, void* data) {
+	memset(a, 0, sizeof(Analysis));
+	for (uint64_t m = getMoves(root->board.player, root->board.opponent); m; m &= m - 1) a->moves[a->legal++].move = lowestBit(m);
+	if (a->legal == 0) return 0;
+	int k = multiPv <= 0 || multiPv > a->legal ? a->legal : multiPv;
+	int empties = popCount(~(root->board.player | root->board.opponent));
+
+	SearchShared shared;
+	shared.start = currentMsec();
+	shared.msec = limits->msec;
+	shared.maxDepth = limits->maxDepth;
+	shared.endgameEmpties = limits->endgameEmpties;
+	shared.probcut = probcutTable ? limits->probcut : 0;
+	shared.cancel = limits->cancel;
+	atomic_init(&shared.stop, 0);
+	SearchContext* ctx = (SearchContext*)calloc(1, sizeof(SearchContext));
+	if (!ctx) return 0;
+	ctx->shared = &shared;
+	ctx->pos = *root;
+	ctx->bestMove = -1;
+	memset(ctx->killerMove, -1, sizeof(ctx->killerMove));
+
+	for (ctx->depth = 1; ctx->depth <= shared.maxDepth; ctx->depth++) {
+		if (!analyzeRoot(ctx, a->moves, a->legal, k, 0)) break;			// keep the scores of the last finished iteration
+		a->depth = ctx->depth;
+
+		// close to the end, solve the moves exactly once the midgame scores have ordered them
+		if (empties <= shared.endgameEmpties && (ctx->depth >= ENDGAME_PREDEPTH || ctx->depth >= empties)) {
+			if (analyzeRoot(ctx, a->moves, a->legal, k, 1)) {
+				a->depth = empties;
+				a->exact = 1;
+			}
+			break;
+		}
+		if (report) {
+			analysisFill(root, ctx, k, shared.start, a);
+			report(a, data);
+		}
+		if (ctx->depth >= empties) break;
+		if (currentMsec() - shared.start >= shared.msec) break;
+	}
+
+	analysisFill(root, ctx, k, shared.start, a);
+	if (report && a->exact) report(a, data);						// the midgame iterations are already reported
+	free(ctx);
+	return k;
+}
+
+//@@***********************************************************************************@@
+// copy the scores of the last finished iteration into the analysis with the pv of each analysed move
+void analysisFill(Position* root, SearchContext* ctx, int k, long long start, Analysis* a) {
+	a->count = k;
+	for (int i = 0; i < k; i++) {
+		a->moves[i].depth = a->depth;
+		a->moves[i].pvLength = principalVariation(root, a->moves[i].move, a->exact, a->depth, a->moves[i].pv);
+	}
+	a->nodes = ctx->nodes;
+	a->msec = currentMsec() - start;
+}
+
+//@@***********************************************************************************@@
+// search every root move at the current depth, or solve it exactly, and sort the moves by the new
+// scores. The moves after the first k only get a bound unless they beat the k-th best score. Return 0
+// if the search was stopped, the old scores stay then
+int analyzeRoot(SearchContext* ctx, MoveAnalysis list[], int n, int k, int solve) {
+	Position* p = &ctx->pos;
+	int scores[BOARD_SIZE * BOARD_SIZE];
+	int low = solve ? -BOARD_SIZE * BOARD_SIZE - 1 : MIN;
+	int high = solve ? BOARD_SIZE * BOARD_SIZE + 1 : MAX;
+	int kth = low;														// the k-th best score so far
+
+	for (int i = 0; i < n; i++) {
+		Undo u;
+		int alpha = i < k ? low : kth;
+		int beta = i < k ? high : kth + 1;
+		int parity = 0;
+		makeMove(p, list[i].move, &u);
+		if (solve) {
+			uint64_t empty = ~(p->board.player | p->board.opponent);
+			for (int q = 0; q < 4; q++) {
+				if (popCount(empty & quadrantMask[q]) & 1) parity |= 1 << q;
+			}
+		}
+		while (1) {
+			scores[i] = solve ? -solveEndgame(ctx, p->board.player, p->board.opponent, -beta, -alpha, parity, 1) :
+				-pvSearch(ctx, -beta, -alpha, 1);
+			if (ctx->abort || scores[i] < beta || beta == high) break;
+			alpha = low;												// better than the k-th move, get the real value
+			beta = high;
+		}
+		undoMove(p, &u);
+		if (ctx->abort) return 0;
+
+		// the k-th best of the scores so far
+		if (i >= k - 1) {
+			int sorted[BOARD_SIZE * BOARD_SIZE];
+			for (int j = 0; j <= i; j++) {
+				int x = j;
+				for (; x > 0 && sorted[x - 1] < scores[j]; x--) sorted[x] = sorted[x - 1];
+				sorted[x] = scores[j];
+			}
+			kth = sorted[k - 1];
+		}
+	}
+
+	// sort the moves by their new scores, the order of equal scores is kept
+	for (int i = 0; i < n; i++) list[i].score = scores[i];
+	for (int i = 1; i < n; i++) {
+		MoveAnalysis m = list[i];
+		int j = i;
+		for (; j > 0 && list[j - 1].score < m.score; j--) list[j] = list[j - 1];
+		list[j] = m;
+	}
+	return 1;
+}
+
+//@@***********************************************************************************@@
+// stop the search when the time budget is used, the cancel flag and the clock are read every 1024 nodes
+int timeUp(SearchContext* ctx) {
+	return stopCheck(ctx, (ctx->nodes & 1023) == 0);
+}
+
+//@@***********************************************************************************@@
+// stop the search when it is cancelled or the time budget is used, the cancel flag and the clock are
+// only read when check is set. The first iteration of the main thread always finishes unless the
+// search is cancelled
+int stopCheck(SearchContext* ctx, int check) {
+	if (ctx->abort) return 1;
+	if (check && ctx->shared->cancel && atomic_load_explicit(ctx->shared->cancel, memory_order_relaxed)) {
+		atomic_store(&ctx->shared->stop, 1);
+		ctx->abort = 1;
+		return 1;
+	}
+	if (ctx->id == 0 && ctx->depth == 1) return 0;
+	if (check && currentMsec() - ctx->shared->start >= ctx->shared->msec)
+		atomic_store(&ctx->shared->stop, 1);
+	if (atomic_load_explicit(&ctx->shared->stop, memory_order_relaxed)) ctx->abort = 1;
+	return ctx->abort;
+}
+
+//@@***********************************************************************************@@
+// negamax alpha-beta search, the scores are seen from the side to move. The first child is searched
+// with the full window, the others with a null window that only proves them worse than the first,
+// a child that fails high is searched again with the full window
+int pvSearch(SearchContext* ctx, int alpha, int beta, int h) {
+	Position* p = &ctx->pos;
+	int moves[BOARD_SIZE * BOARD_SIZE];
+	int childrenSize = 0;
+	int depth = ctx->depth - h;
+	int hashMove = -1;
+	int alphaOrig = alpha;
+	int pathValue = p->identity == 0 ? p->value : -p->value;			// the path part of the evaluation for the side to move
+	ctx->nodes++;
+	ctx->stats.plyNodes[h < STATS_PLY ? h : STATS_PLY - 1]++;
+	if (timeUp(ctx)) return 0;
+	if (depth <= 0) {													// reach the depth limit
+		ctx->stats.evals++;
+		return evaluate(p);
+	}
+
+	HashEntry e;
+	ctx->stats.hashProbes++;
+	if (hashProbe(p->hash, &e)) {
+		ctx->stats.hashHits++;
+		hashMove = e.move;
+		if (h > 0 && e.depth >= depth) {								// the position was already searched deep enough
+			int score = e.score + pathValue;
+			if (e.bound == HASH_EXACT) return score;
+			if (e.bound == HASH_LOWER && score >= beta) return score;
+			if (e.bound == HASH_UPPER && score <= alpha) return score;
+		}
+	}
+	if (h > 0 && depth >= PROBCUT_MIN_DEPTH && ctx->shared->probcut > 0) {
+		int score;
+		if (probcut(ctx, alpha, beta, h, &score)) return score;		// very likely outside the window
+	}
+	childrenSize = expendNode(ctx, moves, hashMove, h);
+	if (childrenSize == 0) {											// when the node cannot be expend
+		if (!getMoves(p->board.opponent, p->board.player)) {			// game over, a won game beats any evaluation
+			int diff = popCount(p->board.player) - popCount(p->board.opponent);
+			ctx->stats.evals++;
+			return finalScore(p->board.player, p->board.opponent) * evaluationUnit() + (diff > 0 ? WIN_BONUS : (diff < 0 ? -WIN_BONUS : 0));
+		}
+		makePass(p);													// the opponent moves again
+		int v = -pvSearch(ctx, -beta, -alpha, h + 1);
+		makePass(p);
+		return v;
+	}
+	int v = MIN;
+	int best = -1;
+	for (int i = 0; i < childrenSize; i++) {
+		Undo u;
+		int score;
+		makeMove(p, moves[i], &u);
+		if (i == 0) score = -pvSearch(ctx, -beta, -alpha, h + 1);
+		else {
+			score = -pvSearch(ctx, -alpha - 1, -alpha, h + 1);
+			if (score > alpha && score < beta && !ctx->abort) {			// better than the first child, get the real value
+				ctx->counters.researches++;
+				score = -pvSearch(ctx, -beta, -alpha, h + 1);
+			}
+		}
+		undoMove(p, &u);
+		if (ctx->abort) return 0;										// the result is incomplete
+		if (score > v) {
+			v = score;
+			best = moves[i];
+		}
+		if (v >= beta) {												// pruning
+			ctx->stats.cutoffs++;
+			ctx->stats.cutIndex[i < STATS_CUT ? i : STATS_CUT - 1]++;
+			updateOrdering(ctx, moves[i], h);
+			break;
+		}
+		if (alpha < v) {												// update alpha
+			alpha = v;
+			if (h == 0) ctx->rootBest = moves[i];						// record the move
+		}
+	}
+	hashStore(p->hash, depth, v >= beta ? HASH_LOWER : (v <= alphaOrig ? HASH_UPPER : HASH_EXACT), v - pathValue, best);
+	return v;
+}
+
+//@@***********************************************************************************@@
+// multi-probcut: the score of a deep search is about the score of a shallow search of the same node
+// plus the fitted mean, with the fitted sigma. When the shallow score is t sigmas above beta (or below
+// alpha) the deep search would very likely fail high (low) too, so the node returns the bound without
+// searching its moves. Deep nodes try a cheap check at a quarter of the depth before the one at a
+// half. The shallow searches run on the same node with a smaller iteration depth. Nodes deeper than
+// the fitted depths search the shallow depth of the last fitted row, so the mean and sigma always
+// belong to the shallow search that was run. Return 1 with the score when the node is cut or the
+// search was stopped
+int probcut(SearchContext* ctx, int alpha, int beta, int h, int* score) {
+	Position* p = &ctx->pos;
+	int depth = ctx->depth - h;
+	int row = depth < PROBCUT_DEPTHS ? depth : PROBCUT_DEPTHS - 2 + (depth & 1);	// deeper nodes use the last fitted depth of the same parity
+	ProbcutPair* pairs = probcutTable + ((size_t)probcutPhase(p->blackNum + p->whiteNum) * PROBCUT_DEPTHS + row) * PROBCUT_DEPTHS;
+	double t = ctx->shared->probcut;
+	int iterationDepth = ctx->depth;
+
+	for (int check = depth >= PROBCUT_MULTI_DEPTH ? 0 : 1; check < 2; check++) {
+		int shallow = probcutShallow(row, check);						// the shallow depth that the pair was fitted for
+		ProbcutPair* pc = &pairs[shallow];
+		if (pc->sigma <= 0) continue;
+		int margin = (int)(t * pc->sigma + 0.5);
+		int mean = (int)(pc->mean < 0 ? pc->mean - 0.5 : pc->mean + 0.5);
+		int high = beta - mean + margin;								// a shallow score this high predicts a fail high
+		int low = alpha - mean - margin;								// this low predicts a fail low
+		int cut = 0;
+		ctx->depth = h + shallow;
+		if (high < MAX && pvSearch(ctx, high - 1, high, h) >= high) {
+			cut = 1;
+			*score = beta;
+		}
+		else if (!ctx->abort && low > MIN && pvSearch(ctx, low, low + 1, h) <= low) {
+			cut = 1;
+			*score = alpha;
+		}
+		ctx->depth = iterationDepth;
+		if (ctx->abort) {
+			*score = 0;
+			return 1;
+		}
+		if (cut) return 1;
+	}
+	return 0;
+}
+
+//@@***********************************************************************************@@
+// phase of a position for multi-probcut, every 10 circles
+int probcutPhase(int discs) {
+	int phase = (discs - 4) / 10;
+	return phase < 0 ? 0 : (phase >= PROBCUT_PHASES ? PROBCUT_PHASES - 1 : phase);
+}
+
+//@@***********************************************************************************@@
+// depth of the shallow search of a check: about a half of the depth for check 1 and a quarter for
+// check 0, with the parity of the depth (odd and even depths score differently in Othello)
+int probcutShallow(int depth, int check) {
+	int shallow = depth / 2;
+	if (check == 0) shallow /= 2;
+	if ((shallow ^ depth) & 1) shallow--;
+	return shallow < 0 ? depth & 1 : shallow;
+}
+
+//@@***********************************************************************************@@
+// the evaluation (path value, circle difference and the features) seen from the side to move
+int evaluate(Position* p) {
+	if (patternWeights) return patternEvaluate(p);
+	int value = p->value + (p->blackNum - p->whiteNum);
+	return (p->identity == 0 ? value : -value) + featureEvaluate(p);
+}
+
+//@@***********************************************************************************@@
+// evaluation points per circle: PATTERN_UNIT with the pattern evaluation, FEATURE_UNIT without it
+int evaluationUnit() {
+	return patternWeights ? PATTERN_UNIT : FEATURE_UNIT;
+}
+
+//@@***********************************************************************************@@
+// the features of the position for the side to move, weighted for its phase: the difference of the
+// moves, of the empty blocks next to the opponent's circles (potential moves), of the opponent's and
+// the own circles next to an empty block, of the stable circles, and the quadrants with an odd number
+// of empties, where the side to move can take the last block
+int featureEvaluate(Position* p) {
+	uint64_t player = p->board.player;
+	uint64_t opponent = p->board.opponent;
+	uint64_t empty = ~(player | opponent);
+	int phase = (p->blackNum + p->whiteNum - 4) / 20;
+	const int* w = featureWeight[phase < FEATURE_PHASES ? phase : FEATURE_PHASES - 1];
+
+	int mobility = popCount(getMoves(player, opponent)) - popCount(getMoves(opponent, player));
+	int potential = popCount(p->frontier & getNeighbours(opponent)) - popCount(p->frontier & getNeighbours(player));
+	uint64_t exposed = getNeighbours(empty);
+	int frontier = popCount(opponent & exposed) - popCount(player & exposed);
+	int stable = popCount(stableCircles(player, opponent)) - popCount(stableCircles(opponent, player));
+	int odd = 0;
+	for (int q = 0; q < 4; q++) odd += popCount(empty & quadrantMask[q]) & 1;
+
+	return w[0] * mobility + w[1] * potential + w[2] * frontier + w[3] * stable + w[4] * odd;
+}
+
+//@@***********************************************************************************@@
+// the circles of p that can never be flipped: the stable circles of the 4 edges from the table, and
+// the circles whose row, column and diagonals are all full
+uint64_t stableCircles(uint64_t p, uint64_t o) {
+	const uint64_t column = 0x0101010101010101ULL;
+	const uint64_t pack = 0x0102040810204080ULL;					// gathers the first column into the top 8 bits
+	uint64_t stable = edgeStable[p & 0xFF][o & 0xFF];
+	stable |= (uint64_t)edgeStable[p >> 56][o >> 56] << 56;
+	stable |= edgeColumn[edgeStable[((p & column) * pack) >> 56][((o & column) * pack) >> 56]];
+	stable |= edgeColumn[edgeStable[(((p >> 7) & column) * pack) >> 56][(((o >> 7) & column) * pack) >> 56]] << 7;
+	return stable | (p & fullLines(p | o));
+}
+
+//@@***********************************************************************************@@
+// the blocks whose row, column and both diagonals are full, a circle there has no line left to be
+// flipped along
+uint64_t fullLines(uint64_t occupied) {
+	uint64_t row = occupied & (occupied >> 1);
+	row &= row >> 2;
+	row &= row >> 4;
+	row = (row & 0x0101010101010101ULL) * 0xFF;						// the first block of a full row fills the row
+	uint64_t column = occupied;
+	column &= (column >> 8) | (column << 56);
+	column &= (column >> 16) | (column << 48);
+	column &= (column >> 32) | (column << 32);
+	uint64_t full = row & column;
+	if (!full) return 0;
+
+	uint64_t diagonal[2] = { 0, 0 };
+	for (int d = 0; d < 2; d++) {
+		for (int i = 0; i < 2 * BOARD_SIZE - 1; i++) {
+			if ((occupied & diagonalMask[d][i]) == diagonalMask[d][i]) diagonal[d] |= diagonalMask[d][i];
+		}
+	}
+	return full & diagonal[0] & diagonal[1];
+}
+
+//@@***********************************************************************************@@
+// build the stable circles of every edge, the first column of every 8 bits and the diagonal masks
+void featureInit() {
+	for (int p = 0; p < 256; p++) {
+		for (int o = 0; o < 256; o++) edgeStable[p][o] = (p & o) ? 0 : edgeStability(p, o, p);
+		edgeColumn[p] = 0;
+		for (int r = 0; r < BOARD_SIZE; r++) {
+			if ((p >> r) & 1) edgeColumn[p] |= 1ULL << (r * BOARD_SIZE);
+		}
+	}
+	memset(diagonalMask, 0, sizeof(diagonalMask));
+	for (int x = 0; x < BOARD_SIZE * BOARD_SIZE; x++) {
+		int r = x / BOARD_SIZE;
+		int c = x % BOARD_SIZE;
+		diagonalMask[0][c - r + BOARD_SIZE - 1] |= 1ULL << x;
+		diagonalMask[1][c + r] |= 1ULL << x;
+	}
+}
+
+//@@***********************************************************************************@@
+// the candidates in stable that stay circles of p whatever is played on the empties of the edge by
+// either side, a move of the board can go to an edge block without flipping on the edge
+int edgeStability(int p, int o, int stable) {
+	int empty = ~(p | o) & 0xFF;
+	stable &= p;
+	if (!stable || !empty) return stable;
+
+	for (int x = 0; x < BOARD_SIZE; x++) {
+		if (!((empty >> x) & 1)) continue;
+		int flips = edgeFlips(p, o, x);								// p plays x
+		stable = edgeStability(p | flips | (1 << x), o & ~flips, stable);
+		if (!stable) return 0;
+		flips = edgeFlips(o, p, x);									// o plays x
+		stable = edgeStability(p & ~flips, o | flips | (1 << x), stable);
+		if (!stable) return 0;
+	}
+	return stable;
+}
+
+//@@***********************************************************************************@@
+// the circles of o on an edge (8 bits) flipped when p moves at x
+int edgeFlips(int p, int o, int x) {
+	int flips = 0;
+	for (int d = -1; d <= 1; d += 2) {
+		int line = 0;
+		int y = x + d;
+		for (; y >= 0 && y < BOARD_SIZE && ((o >> y) & 1); y += d) line |= 1 << y;
+		if (y >= 0 && y < BOARD_SIZE && ((p >> y) & 1)) flips |= line;
+	}
+	return flips;
+}
+
+//@@***********************************************************************************@@
+// solve the root exactly: a win/loss/draw search first, then the exact circle difference inside the
+// side it proved. Return 0 if the time budget ran out, the midgame move is kept then
+int solveRoot(SearchContext* ctx) {
+	uint64_t p = ctx->pos.board.player;
+	uint64_t o = ctx->pos.board.opponent;
+	uint64_t empty = ~(p | o);
+	int parity = 0;
+	for (int q = 0; q < 4; q++) {
+		if (popCount(empty & quadrantMask[q]) & 1) parity |= 1 << q;
+	}
+
+	ctx->rootBest = -1;
+	int v = solveEndgame(ctx, p, o, -1, 1, parity, 0);
+	if (ctx->abort) return 0;
+	if (v != 0) {
+		ctx->rootBest = -1;
+		if (v > 0) v = solveEndgame(ctx, p, o, 0, BOARD_SIZE * BOARD_SIZE + 1, parity, 0);
+		else v = solveEndgame(ctx, p, o, -BOARD_SIZE * BOARD_SIZE - 1, 0, parity, 0);
+		if (ctx->abort) return 0;
+	}
+	ctx->bestMove = ctx->rootBest;
+	ctx->score = v;
+	ctx->completedDepth = popCount(empty);
+	ctx->exact = 1;
+	return 1;
+}
+
+//@@***********************************************************************************@@
+// exact alpha-beta search of an endgame position with principal variation windows. The moves are
+// ordered by the fewest replies for the opponent far from the end, by the parity of the quadrants
+// close to it, and the last 4 empties have their own routines
+int solveEndgame(SearchContext* ctx, uint64_t p, uint64_t o, int alpha, int beta, int parity, int h) {
+	uint64_t empty = ~(p | o);
+	int empties = popCount(empty);
+	ctx->nodes++;
+	ctx->stats.plyNodes[h < STATS_PLY ? h : STATS_PLY - 1]++;
+	if (timeUp(ctx)) return 0;
+	if (empties == 4 && h > 0) return solveLast4(ctx, p, o, alpha, beta, parity);
+
+	uint64_t moveMask = getMoves(p, o);
+	if (!moveMask) {
+		if (!getMoves(o, p)) return finalScore(p, o);					// game over
+		return -solveEndgame(ctx, o, p, -beta, -alpha, parity, h + 1);	// pass
+	}
+
+	// transposition table
+	int alphaOrig = alpha;
+	int hashMove = -1;
+	uint64_t key = 0;
+	if (empties > ENDGAME_HASH) {
+		HashEntry e;
+		key = hashBits(p, o);
+		ctx->stats.hashProbes++;
+		if (hashProbe(key, &e)) {
+			ctx->stats.hashHits++;
+			hashMove = e.move;
+			if (h > 0) {
+				if (e.bound == HASH_EXACT) return e.score;
+				if (e.bound == HASH_LOWER && e.score >= beta) return e.score;
+				if (e.bound == HASH_UPPER && e.score <= alpha) return e.score;
+			}
+		}
+	}
+
+	// order the moves
+	int moves[BOARD_SIZE * BOARD_SIZE];
+	int scores[BOARD_SIZE * BOARD_SIZE];
+	int childrenSize = 0;
+	uint64_t odd = 0;
+	for (int q = 0; q < 4; q++) {
+		if (parity & (1 << q)) odd |= quadrantMask[q];
+	}
+	for (uint64_t l = moveMask; l; l &= l - 1) {
+		int x = lowestBit(l);
+		int score = (odd >> x) & 1;
+		if (x == hashMove) score = 1 << 30;
+		else if (empties > ENDGAME_FASTEST) {
+			uint64_t flips = getFlips(p, o, x);
+			score += (64 - popCount(getMoves(o & ~flips, p | flips | (1ULL << x)))) << 2;
+		}
+		int i = childrenSize++;
+		while (i > 0 && scores[i - 1] < score) {
+			moves[i] = moves[i - 1];
+			scores[i] = scores[i - 1];
+			i--;
+		}
+		moves[i] = x;
+		scores[i] = score;
+	}
+
+	int v = -BOARD_SIZE * BOARD_SIZE - 1;
+	int best = -1;
+	for (int i = 0; i < childrenSize; i++) {
+		if (h < ENDGAME_CHECK && stopCheck(ctx, 1)) return 0;		// the last 4 empties count nodes without checking, so look at the flag here
+		int x = moves[i];
+		uint64_t flips = getFlips(p, o, x);
+		uint64_t np = o & ~flips;
+		uint64_t no = p | flips | (1ULL << x);
+		int np2 = parity ^ (1 << quadrantOf(x));
+		int score;
+		if (i == 0) score = -solveEndgame(ctx, np, no, -beta, -alpha, np2, h + 1);
+		else {
+			score = -solveEndgame(ctx, np, no, -alpha - 1, -alpha, np2, h + 1);
+			if (score > alpha && score < beta && !ctx->abort) {
+				ctx->counters.researches++;
+				score = -solveEndgame(ctx, np, no, -beta, -alpha, np2, h + 1);
+			}
+		}
+		if (ctx->abort) return 0;
+		if (score > v) {
+			v = score;
+			best = x;
+		}
+		if (v >= beta) {												// pruning
+			ctx->stats.cutoffs++;
+			ctx->stats.cutIndex[i < STATS_CUT ? i : STATS_CUT - 1]++;
+			break;
+		}
+		if (alpha < v) {
+			alpha = v;
+			if (h == 0) ctx->rootBest = x;								// record the move
+		}
+	}
+	if (key) hashStore(key, empties, v >= beta ? HASH_LOWER : (v <= alphaOrig ? HASH_UPPER : HASH_EXACT), v, best);
+	return v;
+}
+
+//@@***********************************************************************************@@
+// exact search of the last 4 empties, the empties in the quadrants with odd parity are tried first
+int solveLast4(SearchContext* ctx, uint64_t p, uint64_t o, int alpha, int beta, int parity) {
+	int x[4];
+	int n = 0;
+	uint64_t empty = ~(p | o);
+	for (int pass = 0; pass < 2; pass++) {								// odd quadrants, then even quadrants
+		for (uint64_t l = empty; l; l &= l - 1) {
+			int y = lowestBit(l);
+			if (((parity >> quadrantOf(y)) & 1) != pass) x[n++] = y;
+		}
+	}
+
+	ctx->nodes++;
+	int v = -BOARD_SIZE * BOARD_SIZE - 1;
+	for (int i = 0; i < 4; i++) {
+		uint64_t flips = getFlips(p, o, x[i]);
+		if (!flips) continue;
+		int a = x[i == 0 ? 1 : 0];
+		int b = x[i <= 1 ? 2 : 1];
+		int c = x[i <= 2 ? 3 : 2];
+		int score = -solveLast3(ctx, o & ~flips, p | flips | (1ULL << x[i]), -beta, -alpha, a, b, c);
+		if (score > v) {
+			v = score;
+			if (v >= beta) return v;
+			if (v > alpha) alpha = v;
+		}
+	}
+	if (v == -BOARD_SIZE * BOARD_SIZE - 1) {							// no move
+		if (getFlips(o, p, x[0]) | getFlips(o, p, x[1]) | getFlips(o, p, x[2]) | getFlips(o, p, x[3]))
+			return -solveLast4(ctx, o, p, -beta, -alpha, parity);		// pass
+		return finalScore(p, o);
+	}
+	return v;
+}
+
+//@@***********************************************************************************@@
+// exact search of the last 3 empties
+int solveLast3(SearchContext* ctx, uint64_t p, uint64_t o, int alpha, int beta, int x1, int x2, int x3) {
+	ctx->nodes++;
+	int v = -BOARD_SIZE * BOARD_SIZE - 1;
+	uint64_t flips;
+	if ((flips = getFlips(p, o, x1))) {
+		v = -solveLast2(ctx, o & ~flips, p | flips | (1ULL << x1), -beta, -alpha, x2, x3);
+		if (v >= beta) return v;
+		if (v > alpha) alpha = v;
+	}
+	if ((flips = getFlips(p, o, x2))) {
+		int score = -solveLast2(ctx, o & ~flips, p | flips | (1ULL << x2), -beta, -alpha, x1, x3);
+		if (score > v) {
+			v = score;
+			if (v >= beta) return v;
+			if (v > alpha) alpha = v;
+		}
+	}
+	if ((flips = getFlips(p, o, x3))) {
+		int score = -solveLast2(ctx, o & ~flips, p | flips | (1ULL << x3), -beta, -alpha, x1, x2);
+		if (score > v) v = score;
+	}
+	if (v == -BOARD_SIZE * BOARD_SIZE - 1) {							// no move
+		if (getFlips(o, p, x1) | getFlips(o, p, x2) | getFlips(o, p, x3))
+			return -solveLast3(ctx, o, p, -beta, -alpha, x1, x2, x3);	// pass
+		return finalScore(p, o);
+	}
+	return v;
+}
+
+//@@***********************************************************************************@@
+// exact search of the last 2 empties
+int solveLast2(SearchContext* ctx, uint64_t p, uint64_t o, int alpha, int beta, int x1, int x2) {
+	ctx->nodes++;
+	int v = -BOARD_SIZE * BOARD_SIZE - 1;
+	uint64_t flips;
+	if ((flips = getFlips(p, o, x1))) {
+		v = -solveLast1(ctx, o & ~flips, p | flips | (1ULL << x1), x2);
+		if (v >= beta) return v;
+	}
+	if ((flips = getFlips(p, o, x2))) {
+		int score = -solveLast1(ctx, o & ~flips, p | flips | (1ULL << x2), x1);
+		if (score > v) v = score;
+	}
+	if (v == -BOARD_SIZE * BOARD_SIZE - 1) {							// no move
+		if (getFlips(o, p, x1) | getFlips(o, p, x2))
+			return -solveLast2(ctx, o, p, -beta, -alpha, x1, x2);		// pass
+		return finalScore(p, o);
+	}
+	return v;
+}
+
+//@@***********************************************************************************@@
+// final score of the last empty, whoever can move there plays it
+int solveLast1(SearchContext* ctx, uint64_t p, uint64_t o, int x) {
+	ctx->nodes++;
+	uint64_t flips = getFlips(p, o, x);
+	if (flips) return finalScore(p | flips | (1ULL << x), o & ~flips);
+	flips = getFlips(o, p, x);
+	if (flips) return finalScore(p & ~flips, o | flips | (1ULL << x));
+	return finalScore(p, o);
+}
+
+//@@***********************************************************************************@@
+// circle difference of a finished game, the empty blocks go to the winner
+int finalScore(uint64_t p, uint64_t o) {
+	int pn = popCount(p);
+	int on = popCount(o);
+	int empties = BOARD_SIZE * BOARD_SIZE - pn - on;
+	if (pn > on) return pn - on + empties;
+	if (pn < on) return pn - on - empties;
+	return 0;
+}
+
+//@@***********************************************************************************@@
+// transposition key of an endgame position, mixed from the two bitboards so the solver does not
+// have to keep the zobrist key up to date
+uint64_t hashBits(uint64_t p, uint64_t o) {
+	uint64_t h = p * 0x9E3779B97F4A7C15ULL ^ (o + 0x632BE59BD9B4E019ULL) * 0xC2B2AE3D27D4EB4FULL;
+	h ^= h >> 29;
+	h *= 0xBF58476D1CE4E5B9ULL;
+	h ^= h >> 32;
+	return h;
+}
+
+//@@***********************************************************************************@@
+// follow the best moves stored in the transposition table from the root, the first move is the one
+// the search returned. Stop at the first position that is missing or has no legal stored move
+int principalVariation(Position* root, int move, int exact, int maxLength, int pv[]) {
+	Position p = *root;
+	Undo u;
+	int n = 0;
+	if (move < 0) return 0;
+	if (maxLength > STATS_PLY) maxLength = STATS_PLY;
+	while (n < maxLength) {
+		uint64_t moves = getMoves(p.board.player, p.board.opponent);
+		if (!moves) {
+			if (!getMoves(p.board.opponent, p.board.player)) break;		// game over
+			pv[n++] = -1;
+			makePass(&p);
+			continue;
+		}
+		if (n > 0) {
+			HashEntry e;
+			uint64_t key = exact ? hashBits(p.board.player, p.board.opponent) : p.hash;
+			if (!hashProbe(key, &e) || e.move < 0 || !((moves >> e.move) & 1)) break;
+			move = e.move;
+		}
+		pv[n++] = move;
+		makeMove(&p, move, &u);
+	}
+	while (n > 0 && pv[n - 1] == -1) n--;								// a line does not end with a pass
+	return n;
+}
+
+//@@***********************************************************************************@@
+// quadrant of a block: 0 top left, 1 top right, 2 bottom left, 3 bottom right
+int quadrantOf(int x) {
+	return (x / BOARD_SIZE >= BOARD_SIZE / 2) * 2 + (x % BOARD_SIZE >= BOARD_SIZE / 2);
+}
+
+//@@***********************************************************************************@@
+// expend the position into the list of its children moves, sorted in the order of: the best move
+// from the transposition table, the killer moves of the height, the history of cutoffs, the value
+// of the block (getMoveValue) and the fewest moves left for the opponent, or the fewest blocks added
+// to the frontier next to the leaves
+int expendNode(SearchContext* ctx, int moves[], int hashMove, int h) {
+	Position* p = &ctx->pos;
+	int scores[BOARD_SIZE * BOARD_SIZE];
+	int childrenSize = 0;
+	int depth = ctx->depth - h;
+
+	for (uint64_t l = getMoves(p->board.player, p->board.opponent); l; l &= l - 1) {
+		int x = lowestBit(l);
+		int score;
+		if (depth < 2) {												// next to the leaves sorting costs more than it saves
+			moves[childrenSize] = x;
+			if (x == hashMove) {
+				moves[childrenSize] = moves[0];
+				moves[0] = x;
+			}
+			childrenSize++;
+			continue;
+		}
+		if (x == hashMove) score = 1 << 30;
+		else if (x == ctx->killerMove[h][0]) score = (1 << 30) - 1;
+		else if (x == ctx->killerMove[h][1]) score = (1 << 30) - 2;
+		else {
+			score = (ctx->historyScore[p->identity][x] << 12) + ((moveValue[x] + 100) << 5);
+			if (depth > 2) {											// the opponent's mobility only pays off far from the leaves
+				uint64_t flips = getFlips(p->board.player, p->board.opponent, x);
+				int mobility = popCount(getMoves(p->board.opponent & ~flips, p->board.player | flips | (1ULL << x)));
+				score += 31 - (mobility < 31 ? mobility : 31);
+			}
+			else {														// closer to the leaves the quietest moves, the fewest new empties next to a circle
+				int opened = popCount(neighbourMask[x] & ~(p->frontier | p->board.player | p->board.opponent));
+				score += 31 - 4 * opened;
+			}
+		}
+
+		// insert the move in order
+		int i = childrenSize++;
+		while (i > 0 && scores[i - 1] < score) {
+			moves[i] = moves[i - 1];
+			scores[i] = scores[i - 1];
+			i--;
+		}
+		moves[i] = x;
+		scores[i] = score;
+	}
+	return childrenSize;
+}
+
+//@@***********************************************************************************@@
+// record a move that caused a cutoff, it will be tried early in the siblings' and the later searches
+void updateOrdering(SearchContext* ctx, int move, int h) {
+	if (ctx->killerMove[h][0] != move) {
+		ctx->killerMove[h][1] = ctx->killerMove[h][0];
+		ctx->killerMove[h][0] = move;
+	}
+	int depth = ctx->depth - h;
+	int* history = &ctx->historyScore[ctx->pos.identity][move];
+	*history += depth * depth;
+	if (*history > (1 << 16)) {										// keep the history below the killer moves' scores
+		for (int i = 0; i < 2; i++) {
+			for (int j = 0; j < BOARD_SIZE * BOARD_SIZE; j++) ctx->historyScore[i][j] /= 2;
+		}
+	}
+}
+
+//@@***********************************************************************************@@
+// play a move on the position, everything needed to take it back is stored in the undo record
+void makeMove(Position* p, int x, Undo* u) {
+	uint64_t flips = getFlips(p->board.player, p->board.opponent, x);
+	int flipNum = popCount(flips);
+
+	u->move = x;
+	u->flips = flips;
+	u->value = p->value;
+	u->whiteNum = p->whiteNum;
+	u->blackNum = p->blackNum;
+	u->hash = p->hash;
+	u->frontier = p->frontier;
+
+	// update the zobrist key with the new circle, the flipped circles and the side to move
+	uint64_t key = p->hash ^ zobristDisc[p->identity][x] ^ zobristSide;
+	for (uint64_t f = flips; f; f &= f - 1) key ^= zobristFlip[lowestBit(f)];
+	p->hash = key;
+
+	if (p->identity == 0) {												// black moves
+		p->whiteNum -= flipNum;
+		p->blackNum += flipNum + 1;
+	}
+	else {																// white moves
+		p->whiteNum += flipNum + 1;
+		p->blackNum -= flipNum;
+	}
+
+	// the pattern evaluation has no path part, the new circle and the flipped circles change its indexes
+	if (patternWeights) {
+		int digit = p->identity == 0 ? 1 : 2;
+		patternAdd(p, x, digit);
+		for (uint64_t f = flips; f; f &= f - 1) patternAdd(p, lowestBit(f), 2 * digit - 3);
+	}
+	else p->value += p->identity == 0 ? moveValue[x] : -moveValue[x];
+
+	// only the new circle changes the empty blocks, flipping keeps the frontier
+	p->frontier = (p->frontier | neighbourMask[x]) & ~(p->board.player | p->board.opponent | (1ULL << x));
+
+	// the side to move swaps after the move
+	uint64_t mover = p->board.player | flips | (1ULL << x);
+	p->board.player = p->board.opponent & ~flips;
+	p->board.opponent = mover;
+	p->identity ^= 1;
+}
+
+//@@***********************************************************************************@@
+// take back the move stored in the undo record
+void undoMove(Position* p, Undo* u) {
+	uint64_t mover = p->board.opponent & ~(u->flips | (1ULL << u->move));
+	p->board.opponent = p->board.player | u->flips;
+	p->board.player = mover;
+	p->identity ^= 1;
+
+	if (patternWeights) {
+		int digit = p->identity == 0 ? 1 : 2;
+		patternAdd(p, u->move, -digit);
+		for (uint64_t f = u->flips; f; f &= f - 1) patternAdd(p, lowestBit(f), 3 - 2 * digit);
+	}
+	p->value = u->value;
+	p->whiteNum = u->whiteNum;
+	p->blackNum = u->blackNum;
+	p->hash = u->hash;
+	p->frontier = u->frontier;
+}
+
+//@@***********************************************************************************@@
+// pass the turn to the other side
+void makePass(Position* p) {
+	uint64_t player = p->board.player;
+	p->board.player = p->board.opponent;
+	p->board.opponent = player;
+	p->identity ^= 1;
+	p->hash ^= zobristSide;
+}
+
+//@@***********************************************************************************@@
+// read the 64 board characters (spaces between them are skipped) and the side to move, black when it
+// is missing. Return the text after the position, NULL if it does not start with a board
+const char* readPosition(const char* s, Position* p) {
+	WideMask black, white;
+	int identity;
+	s = readBoard(s, BOARD_SIZE, &black, &white, &identity);
+	if (s) setPosition(p, (uint64_t)black, (uint64_t)white, identity);
+	return s;
+}
+
+//@@***********************************************************************************@@
+// read a line of a position file, return 1 for a position, 0 for a blank line or a comment (#) and -1
+// for a line that is not a position
+int readPositionLine(const char* line, Position* p) {
+	while (*line == ' ' || *line == '\t') line++;
+	if (*line == '#' || *line == '\n' || *line == '\r' || *line == '\0') return 0;
+	return readPosition(line, p) ? 1 : -1;
+}
+
+//@@***********************************************************************************@@
+// read the size * size board characters and the side to move like readPosition
+const char* readBoard(const char* s, int size, WideMask* black, WideMask* white, int* identity) {
+	int x = 0;
+	*black = *white = 0;
+	for (; x < size * size && *s; s++) {
+		if (*s == ' ') continue;
+		if (*s == 'X' || *s == 'x' || *s == 'B' || *s == 'b' || *s == '*') *black |= (WideMask)1 << x;
+		else if (*s == 'O' || *s == 'o' || *s == 'W' || *s == 'w') *white |= (WideMask)1 << x;
+		else if (*s != '-' && *s != '.') return NULL;
+		x++;
+	}
+	if (x < size * size) return NULL;
+
+	while (*s == ' ' || *s == '\t') s++;
+	*identity = *s == 'O' || *s == 'o' || *s == 'W' || *s == 'w';
+	if (*identity || *s == 'X' || *s == 'x' || *s == 'B' || *s == 'b' || *s == '*') s++;
+	return s;
+}
+
+//@@***********************************************************************************@@
+// read a line of a position file of a board size like readPositionLine
+int readBoardLine(const char* line, int size, WideMask* black, WideMask* white, int* identity) {
+	while (*line == ' ' || *line == '\t') line++;
+	if (*line == '#' || *line == '\n' || *line == '\r' || *line == '\0') return 0;
+	return readBoard(line, size, black, white, identity) ? 1 : -1;
+}
+
+//@@***********************************************************************************@@
+// read a move like f5 or F5 (column a - h, row 1 - 8), -1 for a pass (pass or PA), -2 if it is not a move
+int readMove(const char* s) {
+	if ((s[0] == 'p' || s[0] == 'P') && (s[1] == 'a' || s[1] == 'A')) return -1;
+	int c = s[0] >= 'A' && s[0] <= 'Z' ? s[0] - 'A' : s[0] - 'a';
+	int r = s[1] - '1';
+	if (c < 0 || c >= BOARD_SIZE || r < 0 || r >= BOARD_SIZE) return -2;
+	return r * BOARD_SIZE + c;
+}
+
+//@@***********************************************************************************@@
+// write the move as a column letter and a row number (a1 - h8), "pass" when there is no move
+void moveName(int move, char* name) {
+	sizeMoveName(BOARD_SIZE, move, name);
+}
+
+//@@***********************************************************************************@@
+// write the move of a board of that size as a column letter and a row number (a1 - j10 on 10x10)
+void sizeMoveName(int size, int move, char* name) {
+	if (move < 0) strcpy(name, "pass");
+	else sprintf(name, "%c%d", 'a' + move % size, move / size + 1);
+}
+
+//@@***********************************************************************************@@
+// generate the zobrist keys with a fixed seed (splitmix64)
+void initZobrist() {
+	uint64_t seed = 0x4F7468656C6C6FULL;
+	for (int i = 0; i < 2 * BOARD_SIZE * BOARD_SIZE + 1; i++) {
+		seed += 0x9E3779B97F4A7C15ULL;
+		uint64_t z = seed;
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+		z ^= z >> 31;
+		if (i < BOARD_SIZE * BOARD_SIZE) zobristDisc[0][i] = z;
+		else if (i < 2 * BOARD_SIZE * BOARD_SIZE) zobristDisc[1][i - BOARD_SIZE * BOARD_SIZE] = z;
+		else zobristSide = z;
+	}
+	for (int i = 0; i < BOARD_SIZE * BOARD_SIZE; i++) {
+		zobristFlip[i] = zobristDisc[0][i] ^ zobristDisc[1][i];
+	}
+}
+
+//@@***********************************************************************************@@
+// compute the zobrist key of a position from scratch
+uint64_t hashPosition(Position* p) {
+	uint64_t key = p->identity ? zobristSide : 0;
+	for (uint64_t l = p->board.player; l; l &= l - 1) key ^= zobristDisc[p->identity][lowestBit(l)];
+	for (uint64_t l = p->board.opponent; l; l &= l - 1) key ^= zobristDisc[p->identity ^ 1][lowestBit(l)];
+	return key;
+}
+
+//@@***********************************************************************************@@
+// allocate the transposition table, the number of buckets is rounded down to a power of two
+int hashInit(int mb) {
+	uint64_t buckets = 1;
+	if (mb < 1) mb = 1;
+	while (buckets * 2 * sizeof(HashBucket) <= (uint64_t)mb * 1024 * 1024) buckets *= 2;
+
+#if defined(_MSC_VER)
+	if (hashTable) _aligned_free(hashTable);
+	hashTable = (HashBucket*)_aligned_malloc(buckets * sizeof(HashBucket), 64);
+#else
+	if (hashTable) free(hashTable);
+	hashTable = (HashBucket*)aligned_alloc(64, buckets * sizeof(HashBucket));
+#endif
+	if (!hashTable) return 0;
+	hashMask = buckets - 1;
+	hashClear();
+	return 1;
+}
+
+//@@***********************************************************************************@@
+// empty the transposition table
+void hashClear() {
+	memset(hashTable, 0, (hashMask + 1) * sizeof(HashBucket));
+	hashAge = 0;
+}
+
+//@@***********************************************************************************@@
+// look for the entry of a key in its bucket, a slot matches only if it was written as a whole
+int hashProbe(uint64_t key, HashEntry* e) {
+	HashBucket* b = &hashTable[key & hashMask];
+	for (int i = 0; i < HASH_WAYS; i++) {
+		uint64_t data = atomic_load_explicit(&b->slot[i].data, memory_order_relaxed);
+		uint64_t check = atomic_load_explicit(&b->slot[i].check, memory_order_relaxed);
+		if ((check ^ data) == key) {
+			memcpy(e, &data, sizeof(HashEntry));
+			return 1;
+		}
+	}
+	return 0;
+}
+
+//@@***********************************************************************************@@
+// store a search result, a deeper result of the same position is kept, otherwise the entry
+// from an older search or with the lowest depth in the bucket is replaced
+void hashStore(uint64_t key, int depth, int bound, int score, int move) {
+	HashBucket* b = &hashTable[key & hashMask];
+	HashSlot* r = &b->slot[0];
+	int worth = MAX;
+	for (int i = 0; i < HASH_WAYS; i++) {
+		HashSlot* slot = &b->slot[i];
+		uint64_t data = atomic_load_explicit(&slot->data, memory_order_relaxed);
+		uint64_t check = atomic_load_explicit(&slot->check, memory_order_relaxed);
+		HashEntry e;
+		memcpy(&e, &data, sizeof(HashEntry));
+		if ((check ^ data) == key) {
+			if (depth < e.depth && e.age == hashAge) return;			// keep the deeper result
+			r = slot;
+			break;
+		}
+		int w = e.depth + (e.age == hashAge ? 64 : 0);					// empty and old entries go first
+		if (check == 0) w = -1;
+		if (w < worth) {
+			worth = w;
+			r = slot;
+		}
+	}
+
+	HashEntry e;
+	e.score = (int16_t)score;
+	e.depth = (int8_t)depth;
+	e.bound = (uint8_t)bound;
+	e.move = (int8_t)move;
+	e.age = hashAge;
+	e.pad = 0;
+	uint64_t data;
+	memcpy(&data, &e, sizeof(uint64_t));
+	atomic_store_explicit(&r->data, data, memory_order_relaxed);
+	atomic_store_explicit(&r->check, key ^ data, memory_order_relaxed);
+}
+
+//@@***********************************************************************************@@
+// list every pattern on the board: the 8 rotations and mirrors of the first pattern of each kind,
+// without the ones that cover the same blocks as an earlier one
+void patternInit() {
+	int n = 0;
+	int offset = 0;
+	for (int t = 0; t < PATTERN_TYPES; t++) {
+		int length = patternShape[t][0];
+		uint64_t seen[8];
+		int seenNum = 0;
+		for (int s = 0; s < 8; s++) {
+			int blocks[10];
+			uint64_t mask = 0;
+			for (int k = 0; k < length; k++) {
+				int r = patternShape[t][k + 1] / BOARD_SIZE;
+				int c = patternShape[t][k + 1] % BOARD_SIZE;
+				for (int i = 0; i < (s & 3); i++) {						// rotate by 90 degrees
+					int temp = r;
+					r = c;
+					c = BOARD_SIZE - 1 - temp;
+				}
+				if (s & 4) c = BOARD_SIZE - 1 - c;						// mirror
+				blocks[k] = r * BOARD_SIZE + c;
+				mask |= 1ULL << blocks[k];
+			}
+			int repeated = 0;
+			for (int i = 0; i < seenNum; i++) repeated |= seen[i] == mask;
+			if (repeated) continue;
+			seen[seenNum++] = mask;
+
+			patternLength[n] = length;
+			patternOffset[n] = offset;
+			memcpy(patternBlocks[n], blocks, sizeof(blocks));
+			n++;
+		}
+		int size = 1;
+		for (int k = 0; k < length; k++) size *= 3;
+		offset += size;
+	}
+	patternPhaseSize = offset;
+
+	// the patterns of every block and the power of 3 of the block in each of them
+	memset(blockPatterns, 0, sizeof(blockPatterns));
+	for (int i = 0; i < n; i++) {
+		int power = 1;
+		for (int k = 0; k < patternLength[i]; k++) {
+			int x = patternBlocks[i][k];
+			blockPattern[x][blockPatterns[x]] = i;
+			blockPower[x][blockPatterns[x]] = power;
+			blockPatterns[x]++;
+			power *= 3;
+		}
+	}
+}
+
+//@@***********************************************************************************@@
+// compute the index of every pattern from scratch, the digit of a block is 0: empty, 1: black, 2: white
+void patternIndex(uint64_t black, uint64_t white, uint16_t pattern[]) {
+	for (int i = 0; i < PATTERN_COUNT; i++) {
+		int index = 0;
+		for (int k = patternLength[i] - 1; k >= 0; k--) {
+			int x = patternBlocks[i][k];
+			index = index * 3 + ((black >> x) & 1 ? 1 : ((white >> x) & 1 ? 2 : 0));
+		}
+		pattern[i] = (uint16_t)index;
+	}
+}
+
+//@@***********************************************************************************@@
+// add digit times the power of the block x to every pattern of the block
+void patternAdd(Position* p, int x, int digit) {
+	for (int k = 0; k < blockPatterns[x]; k++) p->pattern[blockPattern[x][k]] += digit * blockPower[x][k];
+}
+
+//@@***********************************************************************************@@
+// position of the weight of every pattern inside the weights of a phase
+void patternFeatures(uint16_t pattern[], int features[]) {
+	for (int i = 0; i < PATTERN_COUNT; i++) features[i] = patternOffset[i] + pattern[i];
+}
+
+//@@***********************************************************************************@@
+// number of weights of one phase
+int patternSize() {
+	return patternPhaseSize;
+}
+
+//@@***********************************************************************************@@
+// phase of a position with that many circles, every 5 circles starts a new phase
+int patternPhase(int discs) {
+	int phase = (discs - 4) / 5;
+	return phase < 0 ? 0 : (phase >= PATTERN_PHASES ? PATTERN_PHASES - 1 : phase);
+}
+
+//@@***********************************************************************************@@
+// the weights are seen from black, a weight of PATTERN_SCALE is worth a circle at the end of the game
+int patternEvaluate(Position* p) {
+	int16_t* w = patternWeights + patternPhase(p->blackNum + p->whiteNum) * patternPhaseSize;
+	int sum = 0;
+	for (int i = 0; i < PATTERN_COUNT; i++) sum += w[patternOffset[i] + p->pattern[i]];
+	sum /= PATTERN_SCALE / PATTERN_UNIT;
+	return p->identity == 0 ? sum : -sum;
+}
+
+//@@***********************************************************************************@@
+// load the weights of the pattern evaluation: the magic word, the phases and the weights of a phase as
+// 32-bit words, then the 16-bit weights phase by phase. Return 0 when the file is missing or does not
+// fit the patterns, the old evaluation stays then
+int patternLoad(const char* file) {
+	FILE* in = fopen(file, "rb");
+	if (!in) return 0;
+
+	int32_t header[3];
+	size_t total = (size_t)PATTERN_PHASES * patternPhaseSize;
+	int16_t* weights = NULL;
+	if (fread(header, sizeof(int32_t), 3, in) == 3 && header[0] == PATTERN_MAGIC &&
+		header[1] == PATTERN_PHASES && header[2] == patternPhaseSize) {
+		weights = (int16_t*)malloc(total * sizeof(int16_t));
+		if (weights && fread(weights, sizeof(int16_t), total, in) != total) {
+			free(weights);
+			weights = NULL;
+		}
+	}
+	fclose(in);
+	if (!weights) return 0;
+
+	free(patternWeights);
+	patternWeights = weights;
+	return 1;
+}
+
+//@@***********************************************************************************@@
+// write the weights in the format of patternLoad, return 0 when fails
+int patternSave(const char* file, int16_t* weights) {
+	FILE* out = fopen(file, "wb");
+	if (!out) return 0;
+
+	int32_t header[3] = { PATTERN_MAGIC, PATTERN_PHASES, patternPhaseSize };
+	size_t total = (size_t)PATTERN_PHASES * patternPhaseSize;
+	int ok = fwrite(header, sizeof(int32_t), 3, out) == 3 && fwrite(weights, sizeof(int16_t), total, out) == total;
+	return fclose(out) == 0 && ok;
+}
+
+//@@***********************************************************************************@@
+// load the multi-probcut parameters: the magic word, the number of phases and depths and the checksum
+// of the evaluation they were fitted with (two 32-bit words), then the mean and sigma of every (phase,
+// deep, shallow) as floats. The pairs that the searches use but that were not fitted take the pair of
+// two depths less, so a file fitted to a shallow depth still prunes the deeper searches. Return 0 when
+// fails or the file belongs to another evaluation, the old parameters stay then
+int probcutLoad(const char* file) {
+	FILE* in = fopen(file, "rb");
+	if (!in) return 0;
+
+	int32_t header[5];
+	uint64_t id = evaluationId();
+	size_t total = (size_t)PROBCUT_PHASES * PROBCUT_DEPTHS * PROBCUT_DEPTHS;
+	ProbcutPair* table = NULL;
+	if (fread(header, sizeof(int32_t), 5, in) == 5 && header[0] == PROBCUT_MAGIC && header[1] == PROBCUT_PHASES &&
+		header[2] == PROBCUT_DEPTHS && (uint32_t)header[3] == (uint32_t)id && (uint32_t)header[4] == (uint32_t)(id >> 32)) {
+		table = (ProbcutPair*)malloc(total * sizeof(ProbcutPair));
+		if (table && fread(table, sizeof(ProbcutPair), total, in) != total) {
+			free(table);
+			table = NULL;
+		}
+	}
+	fclose(in);
+	if (!table) return 0;
+
+	for (int phase = 0; phase < PROBCUT_PHASES; phase++) {
+		for (int depth = PROBCUT_MIN_DEPTH + 2; depth < PROBCUT_DEPTHS; depth++) {
+			ProbcutPair* deep = table + ((size_t)phase * PROBCUT_DEPTHS + depth) * PROBCUT_DEPTHS;
+			ProbcutPair* less = deep - 2 * PROBCUT_DEPTHS;
+			for (int check = 0; check < 2; check++) {
+				ProbcutPair* pc = &deep[probcutShallow(depth, check)];
+				if (pc->sigma <= 0) *pc = less[probcutShallow(depth - 2, check)];
+			}
+		}
+	}
+	free(probcutTable);
+	probcutTable = table;
+	return 1;
+}
+
+//@@***********************************************************************************@@
+// write the multi-probcut parameters in the format of probcutLoad for the current evaluation, return
+// 0 when fails
+int probcutSave(const char* file, ProbcutPair* table) {
+	FILE* out = fopen(file, "wb");
+	if (!out) return 0;
+
+	uint64_t id = evaluationId();
+	int32_t header[5] = { PROBCUT_MAGIC, PROBCUT_PHASES, PROBCUT_DEPTHS, (int32_t)(uint32_t)id, (int32_t)(uint32_t)(id >> 32) };
+	size_t total = (size_t)PROBCUT_PHASES * PROBCUT_DEPTHS * PROBCUT_DEPTHS;
+	int ok = fwrite(header, sizeof(int32_t), 5, out) == 5 && fwrite(table, sizeof(ProbcutPair), total, out) == total;
+	return fclose(out) == 0 && ok;
+}
+
+//@@***********************************************************************************@@
+// map a book file and check its header: the magic word, the size of an entry and the number of
+// entries, then the entries sorted by key and move. Return 0 when fails, the old book stays open then
+int bookOpen(const char* file) {
+	int fd = open(file, O_RDONLY);
+	if (fd < 0) return 0;
+
+	struct stat st;
+	void* map = MAP_FAILED;
+	if (fstat(fd, &st) == 0 && st.st_size >= 16) map = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (map == MAP_FAILED) return 0;
+	const int32_t* header = (const int32_t*)map;
+	int64_t count;
+	memcpy(&count, header + 2, sizeof(int64_t));
+	if (header[0] != BOOK_MAGIC || header[1] != (int32_t)sizeof(BookEntry) || count < 0 ||
+		(uint64_t)count != (st.st_size - 16) / sizeof(BookEntry)) {
+		munmap(map, st.st_size);
+		return 0;
+	}
+
+	bookClose();
+	bookMap = map;
+	bookMapSize = st.st_size;
+	bookEntries = (const BookEntry*)((const char*)map + 16);
+	bookCount = (size_t)count;
+	return 1;
+}
+
+//@@***********************************************************************************@@
+// unmap the book, searchPosition searches every position again
+void bookClose() {
+	if (bookMap) munmap(bookMap, bookMapSize);
+	bookMap = NULL;
+	bookMapSize = 0;
+	bookEntries = NULL;
+	bookCount = 0;
+}
+
+//@@***********************************************************************************@@
+// binary search the position in the book and return its best move (the best score, then the deepest
+// search, then the most games) with the score, -1 if the position is not in the book
+int bookProbe(Position* p, int* score) {
+	int symmetries;
+	uint64_t key = canonicalKey(p->board.player, p->board.opponent, &symmetries);
+	size_t low = 0, high = bookCount;
+
+	while (low < high) {												// the first entry of the key
+		size_t mid = low + (high - low) / 2;
+		if (bookEntries[mid].key < key) low = mid + 1;
+		else high = mid;
+	}
+
+	uint64_t moves = getMoves(p->board.player, p->board.opponent);
+	const BookEntry* best = NULL;
+	int bestMove = -1;
+	for (; low < bookCount && bookEntries[low].key == key; low++) {
+		const BookEntry* e = &bookEntries[low];
+		int x = -1;
+		for (uint64_t m = moves; m; m &= m - 1) {						// the move in the orientation of the board
+			if (canonicalMove(lowestBit(m), symmetries) == e->move) x = lowestBit(m);
+		}
+		if (x < 0) continue;
+		if (!best || e->score > best->score || (e->score == best->score &&
+			(e->depth > best->depth || (e->depth == best->depth && e->count > best->count)))) {
+			best = e;
+			bestMove = x;
+		}
+	}
+	if (best) *score = best->score;
+	return bestMove;
+}
+
+//@@***********************************************************************************@@
+// order of the book entries: by key, then by move
+int compareBookEntries(const void* a, const void* b) {
+	const BookEntry* x = (const BookEntry*)a;
+	const BookEntry* y = (const BookEntry*)b;
+	if (x->key != y->key) return x->key < y->key ? -1 : 1;
+	return (int)x->move - (int)y->move;
+}
+
+//@@***********************************************************************************@@
+// sort the entries and write them in the format of bookOpen, return 0 when fails
+int bookSave(const char* file, BookEntry* entries, size_t n) {
+	FILE* out = fopen(file, "wb");
+	if (!out) return 0;
+
+	qsort(entries, n, sizeof(BookEntry), compareBookEntries);
+	int32_t header[2] = { BOOK_MAGIC, (int32_t)sizeof(BookEntry) };
+	int64_t count = (int64_t)n;
+	int ok = fwrite(header, sizeof(int32_t), 2, out) == 2 && fwrite(&count, sizeof(int64_t), 1, out) == 1 &&
+		fwrite(entries, sizeof(BookEntry), n, out) == n;
+	return fclose(out) == 0 && ok;
+}
+
+//@@***********************************************************************************@@
+// the key of a board shared by its 8 rotations and mirrors: the key of the smallest image of the
+// board. symmetries gets a bit for every rotation or mirror that gives that image
+uint64_t canonicalKey(uint64_t p, uint64_t o, int* symmetries) {
+	uint64_t bestP = p, bestO = o;
+	int mask = 1;
+
+	for (int s = 1; s < 8; s++) {
+		uint64_t sp = symmetryBits(p, s);
+		uint64_t so = symmetryBits(o, s);
+		if (sp < bestP || (sp == bestP && so < bestO)) {
+			bestP = sp;
+			bestO = so;
+			mask = 1 << s;
+		}
+		else if (sp == bestP && so == bestO) mask |= 1 << s;
+	}
+	*symmetries = mask;
+	return hashBits(bestP, bestO);
+}
+
+//@@***********************************************************************************@@
+// the move x in the orientation of the key, the smallest block it goes to when the board looks the
+// same in several orientations, so that equal moves of a symmetric board share one entry
+int canonicalMove(int x, int symmetries) {
+	int best = BOARD_SIZE * BOARD_SIZE;
+	for (int s = 0; s < 8; s++) {
+		if (!((symmetries >> s) & 1)) continue;
+		int y = symmetrySquare(x, s);
+		if (y < best) best = y;
+	}
+	return best;
+}
+
+//@@***********************************************************************************@@
+// map a search cache file and index its entries, then keep the file open to append the new results.
+// The file holds the magic word, the size of an entry and the evaluationId as the header, then the
+// entries in the order they were found. A missing file is created. Return 0 when fails or the file
+// belongs to another evaluation, the old cache stays open then
+int cacheOpen(const char* file) {
+	uint64_t id = evaluationId();
+	int32_t header[4] = { CACHE_MAGIC, (int32_t)sizeof(CacheEntry), (int32_t)(id & 0xFFFFFFFFU), (int32_t)(id >> 32) };
+	int fd = open(file, O_RDWR | O_CREAT | O_APPEND, 0644);
+	if (fd < 0) return 0;
+
+	struct stat st;
+	int32_t found[4];
+	void* map = NULL;
+	if (fstat(fd, &st) != 0 || (st.st_size > 0 && (st.st_size < 16 || pread(fd, found, sizeof(found), 0) != 16 ||
+		memcmp(found, header, sizeof(header)) != 0))) {
+		close(fd);
+		return 0;
+	}
+	if (st.st_size == 0 && write(fd, header, sizeof(header)) != 16) {
+		close(fd);
+		return 0;
+	}
+	off_t size = st.st_size > 16 ? 16 + (st.st_size - 16) / (off_t)sizeof(CacheEntry) * (off_t)sizeof(CacheEntry) : st.st_size;
+	if (size != st.st_size && ftruncate(fd, size) != 0) {				// cut off an entry that a crash left half written
+		close(fd);
+		return 0;
+	}
+	if (size > 16 && (map = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0)) == MAP_FAILED) {
+		close(fd);
+		return 0;
+	}
+	FILE* out = fdopen(fd, "ab");
+	if (!out) {
+		if (map) munmap(map, size);
+		close(fd);
+		return 0;
+	}
+
+	cacheClose();
+	if (!cacheLockReady) cacheLockReady = mtx_init(&cacheLock, mtx_plain) == thrd_success;
+	cacheOut = out;
+	if (map) {
+		cacheMap = map;
+		cacheMapSize = size;
+		cacheMapped = (const CacheEntry*)((const char*)map + 16);
+		cacheMappedCount = (size - 16) / sizeof(CacheEntry);
+	}
+	for (size_t n = 0; n < cacheMappedCount; n++) {
+		if (!cacheInsert(n)) break;
+	}
+	return cacheLockReady;
+}
+
+//@@***********************************************************************************@@
+// unmap the cache and close its file, searchPosition does not use a cache any more
+void cacheClose() {
+	if (cacheOut) fclose(cacheOut);
+	if (cacheMap) munmap(cacheMap, cacheMapSize);
+	free(cacheAdded);
+	free(cacheIndex);
+	cacheOut = NULL;
+	cacheMap = NULL;
+	cacheMapSize = 0;
+	cacheMapped = NULL;
+	cacheMappedCount = 0;
+	cacheAdded = NULL;
+	cacheAddedCount = 0;
+	cacheAddedSize = 0;
+	cacheIndex = NULL;
+	cacheIndexMask = 0;
+}
+
+//@@***********************************************************************************@@
+// look the position up in the cache and fill the result when its search is as good as the limits
+// allow: solved exactly, or (when the position is not solved now) as deep as the depth limit or with
+// as much time. Return 0 if there is no such search
+int cacheProbe(Position* p, SearchLimits* limits, SearchResult* result) {
+	int symmetries;
+	uint64_t key = cacheKey(p, &symmetries);
+	int empties = BOARD_SIZE * BOARD_SIZE - popCount(p->board.player | p->board.opponent);
+	CacheEntry e;
+	int found = 0;
+
+	mtx_lock(&cacheLock);
+	for (size_t i = key & cacheIndexMask; cacheIndex && cacheIndex[i]; i = (i + 1) & cacheIndexMask) {
+		const CacheEntry* c = cacheEntryAt(cacheIndex[i] - 1);
+		if (c->key == key) {
+			e = *c;
+			found = 1;
+			break;
+		}
+	}
+	mtx_unlock(&cacheLock);
+	if (!found) return 0;
+	if (!e.exact && (empties <= limits->endgameEmpties || (e.depth < limits->maxDepth && e.msec < limits->msec))) return 0;
+
+	for (uint64_t m = getMoves(p->board.player, p->board.opponent); m; m &= m - 1) {	// the move in the orientation of the board
+		if (canonicalMove(lowestBit(m), symmetries) != e.move) continue;
+		result->move = lowestBit(m);
+		result->score = e.score;
+		result->depth = e.depth;
+		result->exact = e.exact;
+		result->cached = 1;
+		result->pv[0] = result->move;
+		result->pvLength = 1;
+		return 1;
+	}
+	return 0;
+}
+
+//@@***********************************************************************************@@
+// keep the result of a search that is exact or at least CACHE_MIN_DEPTH deep and append it to the file
+void cacheStore(Position* p, SearchLimits* limits, SearchResult* result) {
+	if (result->move < 0 || (!result->exact && result->depth < CACHE_MIN_DEPTH)) return;
+
+	int symmetries;
+	CacheEntry e;
+	memset(&e, 0, sizeof(e));
+	e.key = cacheKey(p, &symmetries);
+	e.score = (int16_t)result->score;
+	e.move = (uint8_t)canonicalMove(result->move, symmetries);
+	e.depth = (uint8_t)(result->depth > 255 ? 255 : result->depth);
+	e.exact = (uint8_t)result->exact;
+	e.msec = (uint16_t)(limits->msec > 65535 ? 65535 : (limits->msec < 0 ? 0 : limits->msec));
+
+	mtx_lock(&cacheLock);
+	if (cacheAddedCount == cacheAddedSize) {
+		size_t size = cacheAddedSize ? 2 * cacheAddedSize : 1024;
+		CacheEntry* added = (CacheEntry*)realloc(cacheAdded, size * sizeof(CacheEntry));
+		if (!added) {
+			mtx_unlock(&cacheLock);
+			return;
+		}
+		cacheAdded = added;
+		cacheAddedSize = size;
+	}
+	cacheAdded[cacheAddedCount++] = e;
+	cacheInsert(cacheMappedCount + cacheAddedCount - 1);
+	fwrite(&e, sizeof(CacheEntry), 1, cacheOut);						// flushed at once, a crash loses nothing
+	fflush(cacheOut);
+	mtx_unlock(&cacheLock);
+}
+
+//@@***********************************************************************************@@
+// the key of a cached position: canonicalKey of the board, changed by zobristSide when white is to move.
+// The evaluation is not the same for both colours, so a depth score of the same board with the other
+// side to move is another result
+uint64_t cacheKey(Position* p, int* symmetries) {
+	return canonicalKey(p->board.player, p->board.opponent, symmetries) ^ (p->identity ? zobristSide : 0);
+}
+
+//@@***********************************************************************************@@
+// the entry number n: the mapped entries come first, then the added ones
+const CacheEntry* cacheEntryAt(size_t n) {
+	return n < cacheMappedCount ? &cacheMapped[n] : &cacheAdded[n - cacheMappedCount];
+}
+
+//@@***********************************************************************************@@
+// put the entry number n in the index when it is better than the entry of its key there (exact, then
+// more time, then deeper). The index doubles when it is half full. Return 0 when out of memory
+int cacheInsert(size_t n) {
+	size_t total = cacheMappedCount + cacheAddedCount;
+	if (!cacheIndex || total * 2 > cacheIndexMask + 1) {
+		size_t size = cacheIndex ? 2 * (cacheIndexMask + 1) : 4096;
+		while (total * 2 > size) size *= 2;
+		uint32_t* index = (uint32_t*)calloc(size, sizeof(uint32_t));
+		if (!index) return 0;
+		uint32_t* old = cacheIndex;
+		size_t oldSize = cacheIndex ? cacheIndexMask + 1 : 0;
+		cacheIndex = index;
+		cacheIndexMask = size - 1;
+		for (size_t i = 0; i < oldSize; i++) {							// the old slots hold one entry per key
+			if (!old[i]) continue;
+			size_t j = cacheEntryAt(old[i] - 1)->key & cacheIndexMask;
+			while (cacheIndex[j]) j = (j + 1) & cacheIndexMask;
+			cacheIndex[j] = old[i];
+		}
+		free(old);
+	}
+
+	const CacheEntry* e = cacheEntryAt(n);
+	size_t i = e->key & cacheIndexMask;
+	for (; cacheIndex[i]; i = (i + 1) & cacheIndexMask) {
+		const CacheEntry* c = cacheEntryAt(cacheIndex[i] - 1);
+		if (c->key != e->key) continue;
+		if (e->exact > c->exact || (e->exact == c->exact && (e->msec > c->msec ||
+			(e->msec == c->msec && e->depth >= c->depth)))) cacheIndex[i] = (uint32_t)(n + 1);
+		return 1;
+	}
+	cacheIndex[i] = (uint32_t)(n + 1);
+	return 1;
+}
+
+//@@***********************************************************************************@@
+// checksum of the evaluation, a hash of the feature weights without patterns and of the weights for
+// the pattern evaluation, so a cache is not used with scores of another evaluation
+uint64_t evaluationId() {
+	uint64_t h = 0xCBF29CE484222325ULL;
+	const uint8_t* bytes = patternWeights ? (const uint8_t*)patternWeights : (const uint8_t*)featureWeight;
+	size_t size = patternWeights ? (size_t)PATTERN_PHASES * patternPhaseSize * sizeof(int16_t) : sizeof(featureWeight);
+	for (size_t i = 0; i < size; i++) h = (h ^ bytes[i]) * 0x100000001B3ULL;
+	return h | 1;
+}
+
+//@@***********************************************************************************@@
+// count the bits of a wide mask
+int widePopCount(WideMask x) {
+	return popCount((uint64_t)x) + popCount((uint64_t)(x >> 64));
+}
+
+//@@***********************************************************************************@@
+// index of the lowest bit of a non-empty wide mask
+int wideLowestBit(WideMask x) {
+	return (uint64_t)x ? lowestBit((uint64_t)x) : 64 + lowestBit((uint64_t)(x >> 64));
+}
+
+//@@***********************************************************************************@@
+// stop the search of a board size when it is cancelled or the time budget is used, like stopCheck: the
+// cancel flag and the clock are only read when check is set and the first iteration of the main thread
+// always finishes unless the search is cancelled
+int sizeStop(SizeSearch* s, int check) {
+	SizeShared* shared = s->shared;
+	if (s->abort) return 1;
+	if (check && shared->limits->cancel && atomic_load_explicit(shared->limits->cancel, memory_order_relaxed)) {
+		atomic_store(&shared->stop, 1);
+		s->abort = 1;
+		return 1;
+	}
+	if (s->id == 0 && s->depth == 1) return 0;
+	if (check && currentMsec() - shared->start >= shared->limits->msec) atomic_store(&shared->stop, 1);
+	if (atomic_load_explicit(&shared->stop, memory_order_relaxed)) s->abort = 1;
+	return s->abort;
+}
+
+//@@***********************************************************************************@@
+// record a move that caused a cutoff in the search of a board size, like updateOrdering
+void sizeUpdateOrdering(SizeSearch* s, int move, int depth, int h) {
+	int k = h < STATS_PLY ? h : STATS_PLY - 1;
+	if (s->killerMove[k][0] != move) {
+		s->killerMove[k][1] = s->killerMove[k][0];
+		s->killerMove[k][0] = move;
+	}
+	s->historyScore[move] += depth * depth;
+	if (s->historyScore[move] > (1 << 16)) {						// keep the history below the killer moves' scores
+		for (int i = 0; i < MAX_BOARD_SIZE * MAX_BOARD_SIZE; i++) s->historyScore[i] /= 2;
+	}
+}
+
+//@@***********************************************************************************@@
+// the search of the 8x8 kernels is the engine's, with its table, book, cache and evaluation
+int sizeSearchEngine(WideMask black, WideMask white, int identity, SearchLimits* limits, SearchResult* result) {
+	Position p;
+	setPosition(&p, (uint64_t)black, (uint64_t)white, identity);
+	return searchPosition(&p, limits, result);
+}
+
+// the kernels of every board size, the 8x8 board moves with the kernels and searches with the engine
+#define SIZE_PASTE(f, n) SIZE_PASTE_NOW(f, n)
+#define SIZE_PASTE_NOW(f, n) f##n
+
+#define SIZE_N 6
+#define SIZE_MASK uint64_t
+#define SIZE_COUNT popCount
+#define SIZE_LOWEST lowestBit
+#include "othello_size.h"
+
+#define SIZE_N 8
+#define SIZE_MASK uint64_t
+#define SIZE_COUNT popCount
+#define SIZE_LOWEST lowestBit
+#define SIZE_ENGINE
+#include "othello_size.h"
+
+#define SIZE_N 10
+#define SIZE_MASK WideMask
+#define SIZE_COUNT widePopCount
+#define SIZE_LOWEST wideLowestBit
+#include "othello_size.h"
+
+//@@***********************************************************************************@@
+// fill the square values of every board size
+void sizeInit() {
+	sizeInit6();
+	sizeInit8();
+	sizeInit10();
+}
+
+//@@***********************************************************************************@@
+// the kernels of a board size, NULL if the size is not supported. Every size has its own functions, so
+// the choice is made once here and not in the moves or the search
+const SizeKernels* sizeSelect(int size) {
+	const SizeKernels* kernels[] = { &sizeKernels6, &sizeKernels8, &sizeKernels10 };
+	for (int i = 0; i < (int)(sizeof(kernels) / sizeof(kernels[0])); i++) {
+		if (kernels[i]->size == size) return kernels[i];
+	}
+	return NULL;
+}
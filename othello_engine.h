@@ -0,0 +1,386 @@
+/*
+*** FILE NAME   : othello_engine.h
+*** PURPOSE		: Rules and alpha-beta search of the Othello ai, without any openGL dependency
+*** DESCRIPTION : The engine works on bitboards (one 64-bit mask for each side). It generates the moves
+				  and flips, searches a position with iterative deepening, principal variation search,
+				  a shared transposition table and several threads, and solves the endgame exactly.
+				  The 6x6 and 10x10 boards get their own kernels and search from othello_size.h.
+				  It is used by the openGL game (othello_ex.c) and the headless tools (othello_cli.c).
+*/
+
+#ifndef OTHELLO_ENGINE_H
+#define OTHELLO_ENGINE_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdatomic.h>
+
+
+//@@***********************************************************************************@@
+// Constants
+#define BOARD_SIZE 8					// blocks on a side of the engine's positions, the other sizes are played with sizeSelect
+#define MAX_BOARD_SIZE 10				// largest board of sizeSelect, its blocks fit in a WideMask
+#define MIN -5000
+#define MAX 5000
+#define WHITE 1
+#define BLACK 2
+#define ALPHABETAHEIGHT 60				// Deepest iteration for the alpha beta program
+#define SEARCH_MSEC 1000				// default time budget for each ai move in ms
+#define ASPIRATION 24					// half width of the first aspiration window around the previous score
+#define WIN_BONUS 1000					// added to the evaluation of a finished game that is won
+#define ENDGAME_EMPTIES 16				// default number of empty blocks from which the game is solved exactly
+#define ENDGAME_PREDEPTH 4				// midgame depth searched before the exact solve, its move is kept if the solve runs out of time
+#define ENDGAME_FASTEST 7				// above this many empties the solver tries the moves that leave the opponent the fewest replies first
+#define ENDGAME_HASH 8					// above this many empties the solver uses the transposition table
+#define ENDGAME_CHECK 6					// the solver checks the cancel flag and the clock before every move of its first plies
+#define HASH_MB 16						// default size of the transposition table in MB
+#define HASH_WAYS 4						// entries in a bucket, a bucket fills one cache line
+#define HASH_EXACT 0					// bound type of a table entry: exact value
+#define HASH_LOWER 1					// the value is a lower bound (fail high)
+#define HASH_UPPER 2					// the value is an upper bound (fail low)
+#define MAX_THREADS 256					// most search threads allowed
+#define STATS_PLY (ALPHABETAHEIGHT + 4)	// plies and depths counted in the search statistics, passes make a line longer than the depth
+#define PATTERN_FILE "othello.weights"	// weights of the pattern evaluation loaded at startup when no other file is given
+#define PATTERN_TYPES 11				// kinds of patterns: edge+2X, corner 3x3, corner 2x5, 5 diagonals and 3 lines
+#define PATTERN_COUNT 46				// patterns on the board, the rotations and mirrors of a kind share its weights
+#define PATTERN_PHASES 12				// game phases with their own weights, every 5 circles on the board
+#define PATTERN_SCALE 128				// the weights are stored in 1/PATTERN_SCALE of a circle
+#define PATTERN_UNIT 8					// evaluation points per circle with the pattern evaluation
+#define FEATURE_UNIT 16					// evaluation points per circle of the final margin with the feature evaluation, fitted on self-play games
+#define PATTERN_MAGIC 0x5748544F		// first word of a weights file ("OTHW")
+#define STATS_CUT 8						// indexes of the cutting move counted one by one, the last slot counts the later moves
+#define BOOK_FILE "othello.book"		// opening book mapped at startup when no other file is given
+#define BOOK_MAGIC 0x4B42544F			// first word of a book file ("OTBK")
+#define BOOK_UNIT 8						// the book scores are in 1/BOOK_UNIT of a circle
+#define CACHE_MAGIC 0x3243544F			// first word of a search cache file ("OTC2", the keys hold the side to move)
+#define CACHE_MIN_DEPTH 8				// shallower searches that are not exact are not kept in the search cache
+#define PROBCUT_FILE "othello.probcut"	// multi-probcut parameters loaded at startup when no other file is given
+#define PROBCUT_MAGIC 0x4350544F		// first word of a multi-probcut file ("OTPC")
+#define PROBCUT_PHASES 6				// game phases with their own parameters, every 10 circles on the board
+#define PROBCUT_DEPTHS 24				// depths with their own parameters, deeper searches use the last two
+#define PROBCUT_MIN_DEPTH 3				// shallowest remaining depth that is pruned by multi-probcut
+#define PROBCUT_MULTI_DEPTH 8			// from this remaining depth a cheaper check at a quarter of the depth comes first
+#define PROBCUT_T 1.5					// default selectivity, the cut needs t sigmas of the shallow score beyond the window
+#define SIMD_SCALAR 0					// move and flip kernels: one direction after the other
+#define SIMD_AVX2 1						// 4 directions at once with AVX2
+#define SIMD_AVX512 2					// all 8 directions at once with AVX-512
+#define FEATURE_COUNT 5					// features of the evaluation without patterns: mobility, potential mobility, frontier, stability, parity
+#define FEATURE_PHASES 3				// game phases with their own feature weights, every 20 circles on the board
+#define SIZE_MOBILITY 10				// evaluation points per move of mobility difference on the other board sizes, the midgame feature weight
+
+
+//@@***********************************************************************************@@
+// Structs
+
+// Bitboard of a state, bit (r * BOARD_SIZE + c) stands for the block at row r and column c
+typedef struct bitboard {
+	uint64_t player;					// circles of the side to move
+	uint64_t opponent;					// circles of the other side
+} Bitboard;
+
+// Position that the search works on, changed in place by makeMove and restored by undoMove
+typedef struct position {
+	Bitboard board;						// the board, seen from the side to move
+	int value;							// the increment step value (part of evaluation), seen from black
+	int whiteNum;						// white number of the position
+	int blackNum;						// black number of the position
+	int identity;						// side to move, 0: black (the ai in the game), 1: white
+	uint64_t hash;						// zobrist key of the board and the side to move
+	uint64_t frontier;					// empty blocks next to a circle, kept move by move for the potential mobility of the evaluation and the move order
+	uint16_t pattern[PATTERN_COUNT];	// base-3 index of every pattern (0: empty, 1: black, 2: white), kept only with the pattern evaluation
+} Position;
+
+// Record that uses to undo a move
+typedef struct undo {
+	int move;							// the position of the move (0 - 63)
+	uint64_t flips;						// the circles flipped by the move
+	int value;							// value before the move
+	int whiteNum;						// white number before the move
+	int blackNum;						// black number before the move
+	uint64_t hash;						// zobrist key before the move
+	uint64_t frontier;					// frontier before the move
+} Undo;
+
+// Search result kept in the transposition table, packed in 64 bits
+typedef struct hashEntry {
+	int16_t score;						// searched value minus the value of the position (the path part of the evaluation)
+	int8_t depth;						// remaining depth that was searched
+	uint8_t bound;						// HASH_EXACT, HASH_LOWER or HASH_UPPER
+	int8_t move;						// best move found (-1 if none)
+	uint8_t age;						// search generation that wrote the entry
+	uint16_t pad;
+} HashEntry;
+
+// Slot of the transposition table, the threads share it without locks: the check word is the zobrist
+// key xor the packed entry, so an entry half written by another thread never matches its key
+typedef struct hashSlot {
+	_Atomic uint64_t check;				// zobrist key ^ data, 0 when empty
+	_Atomic uint64_t data;				// the packed HashEntry
+} HashSlot;
+
+// A bucket of slots that shares one cache line
+typedef struct hashBucket {
+	HashSlot slot[HASH_WAYS];
+} HashBucket;
+
+// Score of a move in the opening book, the book file holds them sorted by key and move
+typedef struct bookEntry {
+	uint64_t key;						// canonicalKey of the position
+	int16_t score;						// score of the move for the side to move in 1/BOOK_UNIT circle
+	uint8_t move;						// the move in the orientation of the key (canonicalMove)
+	uint8_t depth;						// depth of the search that scored the move, 0 when it is the average result of games
+	uint32_t count;						// number of games that played the move
+} BookEntry;
+
+// Result of a search kept in the search cache file, the file holds them in the order they were found
+typedef struct cacheEntry {
+	uint64_t key;						// cacheKey of the position
+	int16_t score;						// score of the move for the side to move
+	uint8_t move;						// the move in the orientation of the key (canonicalMove)
+	uint8_t depth;						// depth of the last finished iteration, the empties when exact
+	uint8_t exact;						// 1 when the game was solved exactly
+	uint8_t pad;
+	uint16_t msec;						// time budget of the search in ms, at most 65535
+} CacheEntry;
+
+// How the score of a deep search differs from a shallow one of the same position: deep - shallow has
+// this mean and standard deviation
+typedef struct probcutPair {
+	float mean;							// mean of deep - shallow
+	float sigma;						// standard deviation of deep - shallow, 0 when the pair is not used
+} ProbcutPair;
+
+// Counters that show how well the windows of the search work
+typedef struct searchCounters {
+	int researches;						// null window searches that failed high and were searched again
+	int failHighs;						// aspiration windows that failed high at the root
+	int failLows;						// aspiration windows that failed low at the root
+} SearchCounters;
+
+// Statistics that a search thread fills in, summed over the threads in the result
+typedef struct searchStats {
+	long long plyNodes[STATS_PLY];		// nodes visited on each ply from the root (the last 4 empties of the solver are not included)
+	long long evals;					// leaf evaluations
+	long long cutoffs;					// beta cutoffs
+	long long cutIndex[STATS_CUT];		// beta cutoffs by the index of the move that caused it
+	long long hashProbes;				// transposition table probes
+	long long hashHits;					// probes that found the position
+	int iterations;						// deepest finished iteration of the main thread
+	long long iterNodes[STATS_PLY];		// nodes of the main thread when each depth finished
+	long long iterMsec[STATS_PLY];		// time in ms from the start when each depth finished
+	int iterScore[STATS_PLY];			// score of the main thread at each depth
+} SearchStats;
+
+// Limits of one search
+typedef struct searchLimits {
+	int msec;							// time budget in ms
+	int maxDepth;						// deepest iteration allowed
+	int threads;						// number of search threads
+	int endgameEmpties;					// number of empty blocks from which the game is solved exactly
+	double probcut;						// selectivity of multi-probcut in sigmas, 0 searches every move to the full depth
+	atomic_int* cancel;					// another thread sets it to stop the search early, NULL if not used
+	int ponder;							// 1 for a search while waiting for the opponent, the table keeps the age of the last real search
+} SearchLimits;
+
+// What one search found
+typedef struct searchResult {
+	int move;							// best move (0 - 63), -1 if the side to move has none
+	int score;							// score of the move for the side to move, the final circle difference when exact
+	int depth;							// depth of the last finished iteration, the empties when exact
+	int exact;							// 1 when the game was solved exactly
+	int threads;						// number of threads that searched
+	long long nodes;					// nodes visited by all the threads
+	long long msec;						// time used in ms
+	SearchCounters counters;			// window counters of all the threads
+	SearchStats stats;					// statistics of all the threads, the iterations are the main thread's
+	double branching;					// effective branching factor, nodes of the last iteration over the one before
+	int pv[STATS_PLY];					// principal variation from the transposition table, -1 for a pass
+	int pvLength;						// number of moves in pv
+	int book;							// 1 when the move came from the opening book without a search
+	int cached;							// 1 when the move came from the search cache without a search
+} SearchResult;
+
+// Bitboard of any board size up to MAX_BOARD_SIZE, bit (r * size + c) stands for the block at row r and column c
+typedef unsigned __int128 WideMask;
+
+// Rules and search of one board size, generated by othello_size.h for every size and chosen with sizeSelect
+typedef struct sizeKernels {
+	int size;							// blocks on a side
+	WideMask startBlack;				// black circles of the start position
+	WideMask startWhite;				// white circles of the start position
+	WideMask (*moves)(WideMask p, WideMask o);			// all the valid moves for p against o
+	WideMask (*flips)(WideMask p, WideMask o, int x);	// the circles of o flipped when p moves at x
+	long long (*perft)(WideMask p, WideMask o, int depth);	// paths of depth plies with p to move, a pass takes one ply
+	int (*search)(WideMask black, WideMask white, int identity, SearchLimits* limits, SearchResult* result);	// search the best move, return it or -1
+} SizeKernels;
+
+// Settings and state that all the threads of the search of a board size share
+typedef struct sizeShared {
+	SearchLimits* limits;				// limits of the search
+	long long start;					// wall-clock time in ms when the search started
+	WideMask player;					// circles of the side to move at the root
+	WideMask opponent;					// circles of the other side at the root
+	atomic_int stop;					// set when the time budget runs out or the main thread is done
+} SizeShared;
+
+// Everything that one thread of the search of a board size owns, the SearchContext of the other sizes
+typedef struct sizeSearch {
+	int id;								// thread number, 0 is the main thread
+	SizeShared* shared;					// settings of the search
+	int depth;							// depth of the current iteration, the empties while solving
+	int solving;						// 1 while the game is solved, the scores are the final circle differences
+	int abort;							// set when the current iteration is stopped, its result is dropped
+	long long nodes;					// nodes visited by the thread
+	int rootBest;						// best move of the current iteration
+	int bestMove;						// best move of the last finished iteration
+	int score;							// score of the last finished iteration
+	int completedDepth;					// depth of the last finished iteration
+	int exact;							// 1 when the endgame was solved exactly
+	int killerMove[STATS_PLY][2];		// the last two moves that caused a cutoff on each height
+	int historyScore[MAX_BOARD_SIZE * MAX_BOARD_SIZE];	// cutoff history of each move
+	SearchCounters counters;			// window counters of the thread
+	SearchStats stats;					// statistics of the thread
+} SizeSearch;
+
+// Analysis of one root move
+typedef struct moveAnalysis {
+	int move;							// the move (0 - 63)
+	int score;							// score of the move for the side to move, the final circle difference when exact
+	int depth;							// depth of the search of the move, the empties when exact
+	int pv[STATS_PLY];					// principal variation that starts with the move, -1 for a pass
+	int pvLength;						// number of moves in pv
+} MoveAnalysis;
+
+// What an analysis of a position found: the scores of its best moves
+typedef struct analysis {
+	int count;							// number of analysed moves in moves, the best first
+	int legal;							// number of legal moves of the position
+	int depth;							// depth of the last finished iteration, the empties when exact
+	int exact;							// 1 when the scores are exact
+	long long nodes;					// nodes visited
+	long long msec;						// time used in ms
+	MoveAnalysis moves[BOARD_SIZE * BOARD_SIZE];	// the analysed moves, then the other legal moves without real scores
+} Analysis;
+
+// Called by analyzePosition with the analysis of every finished iteration and the data of the caller
+typedef void (*AnalysisReport)(Analysis* a, void* data);
+
+// Settings and state that all the threads of one search share
+typedef struct searchShared {
+	long long start;					// time when the search started in ms
+	int msec;							// time budget in ms
+	int maxDepth;						// deepest iteration allowed
+	int endgameEmpties;					// number of empty blocks from which the game is solved exactly
+	double probcut;						// selectivity of multi-probcut, 0 when it is off
+	atomic_int* cancel;					// set by another thread to stop the search, NULL if not used
+	atomic_int stop;					// set when the time budget runs out or the main thread is done
+} SearchShared;
+
+// Everything that one search thread owns, nothing in it is written by another thread
+typedef struct searchContext {
+	int id;								// thread number, 0 is the main thread
+	SearchShared* shared;				// settings of the search
+	Position pos;						// the thread's own copy of the root position, changed by makeMove/undoMove
+	int depth;							// depth of the current iteration
+	int abort;							// set when the current iteration is stopped, its result is dropped
+	long long nodes;					// nodes visited by the thread
+	int rootBest;						// best move of the current iteration
+	int bestMove;						// best move of the last finished iteration
+	int score;							// score of the last finished iteration
+	int completedDepth;					// depth of the last finished iteration
+	int exact;							// 1 when the endgame was solved exactly
+	int killerMove[ALPHABETAHEIGHT + 1][2];		// the last two moves that caused a cutoff on each height
+	int historyScore[2][BOARD_SIZE * BOARD_SIZE];	// cutoff history of each move for black [0] and white [1]
+	SearchCounters counters;			// window counters of the thread
+	SearchStats stats;					// statistics of the thread
+} SearchContext;
+
+
+//@@***********************************************************************************@@
+// Function
+
+int engineInit(int hashMB);									// set up the zobrist keys and the transposition table, return 0 when fails
+void defaultLimits(SearchLimits* limits);					// the default limits of a search
+int searchPosition(Position* root, SearchLimits* limits, SearchResult* result);	// search the best move of a position, return the move or -1
+long long currentMsec();									// wall-clock time in ms
+void writeSearchJson(FILE* out, SearchResult* result);		// write the result and its statistics as one JSON line
+int analyzePosition(Position* root, SearchLimits* limits, int multiPv, Analysis* a, AnalysisReport report, void* data);	// score the best multiPv moves (all when 0), return the number
+void writeAnalysisJson(FILE* out, int index, Analysis* a);	// write an analysis as one JSON line
+
+// rules
+void setPosition(Position* p, uint64_t black, uint64_t white, int identity);	// set up a position, identity 0: black to move, 1: white to move
+void startPosition(Position* p, int identity);	// set up the start position, 4 circles in the middle
+uint64_t getMoves(uint64_t p, uint64_t o);					// all the valid moves for p against o
+uint64_t getFlips(uint64_t p, uint64_t o, int x);			// the circles of o flipped when p moves at x
+uint64_t getNeighbours(uint64_t b);							// the blocks next to the blocks of b
+int simdSelect(int level);									// use the fastest kernels of getMoves and getFlips up to the level (SIMD_*) that the cpu supports, return it
+void makeMove(Position* p, int x, Undo* u);					// play the move x on the position and fill the undo record
+void undoMove(Position* p, Undo* u);						// take back the move recorded in u
+void makePass(Position* p);									// pass the turn, a pass is undone by passing again
+int finalScore(uint64_t p, uint64_t o);						// circle difference of a finished game, the empties go to the winner
+int popCount(uint64_t x);									// number of bits in x
+int lowestBit(uint64_t x);									// index of the lowest bit in x (x != 0)
+uint64_t symmetryBits(uint64_t x, int s);					// one of the 8 rotations and mirrors (0 - 7) of a mask
+int symmetrySquare(int x, int s);							// the block that x goes to under the same rotation or mirror
+
+// notation of the tools: a position is 64 board characters (X, B or * for black, O or W for white, - or
+// . for an empty block, size * size of them on the other board sizes) and the side to move, a move is a
+// column letter and a row number like f5
+const char* readPosition(const char* s, Position* p);		// read a board and the side to move, return the rest of the text or NULL if it is not a position
+int readPositionLine(const char* line, Position* p);		// read a line of positions, return 1 for a position, 0 for a blank line or a comment, -1 otherwise
+const char* readBoard(const char* s, int size, WideMask* black, WideMask* white, int* identity);	// readPosition of a board of any size
+int readBoardLine(const char* line, int size, WideMask* black, WideMask* white, int* identity);	// readPositionLine of a board of any size
+int readMove(const char* s);								// a move like f5 or F5, -1 for a pass (pass or PA), -2 if it is not a move
+void moveName(int move, char* name);						// write the move like f5, pass when there is no move
+void sizeMoveName(int size, int move, char* name);			// moveName on a board of any size, like j10
+
+// board sizes, each size has its own kernels with the masks and tables of its board built in
+const SizeKernels* sizeSelect(int size);					// the kernels of a board size (6, 8 or 10), NULL if it is not supported
+int sizeStop(SizeSearch* s, int check);					// stopCheck of the search of a board size
+int widePopCount(WideMask x);								// number of bits in x
+int wideLowestBit(WideMask x);								// index of the lowest bit in x (x != 0)
+
+// evaluation
+int getMoveValue(int r, int c);								// part of evaluation, will be added to the node when the node is created
+int sizeMoveValue(int size, int r, int c);					// getMoveValue of a block of a board of that size
+int evaluate(Position* p);									// evaluation seen from the side to move
+int evaluationUnit();										// evaluation points per circle of the evaluation in use
+
+// pattern evaluation, used instead of the path values and the circle difference when its weights are loaded
+int patternLoad(const char* file);							// load the weights, return 0 when fails and the old evaluation stays
+int patternSave(const char* file, int16_t* weights);		// write PATTERN_PHASES * patternSize() weights to a file, return 0 when fails
+int patternSize();											// number of weights of one phase
+int patternPhase(int discs);								// phase of a position with that many circles
+void patternIndex(uint64_t black, uint64_t white, uint16_t pattern[]);	// compute the index of every pattern from scratch
+void patternFeatures(uint16_t pattern[], int features[]);	// position of the weight of every pattern inside a phase
+
+// multi-probcut, the midgame search prunes the moves whose shallow search is far outside the window when its parameters are loaded
+int probcutLoad(const char* file);							// load the parameters fitted for the current evaluation, return 0 when fails
+int probcutSave(const char* file, ProbcutPair* table);		// write PROBCUT_PHASES * PROBCUT_DEPTHS * PROBCUT_DEPTHS pairs (phase, deep, shallow), return 0 when fails
+int probcutPhase(int discs);								// phase of a position with that many circles
+int probcutShallow(int depth, int check);					// depth of the shallow search of check 0 (a quarter) or 1 (a half)
+
+// opening book, searchPosition plays the book move of a position without searching when a book is open
+int bookOpen(const char* file);								// map a book file, return 0 when fails and the old book stays
+void bookClose();											// unmap the book
+int bookProbe(Position* p, int* score);						// the best book move of the position and its score, -1 if it is not in the book
+int bookSave(const char* file, BookEntry* entries, size_t n);	// sort the entries and write them as a book file, return 0 when fails
+int compareBookEntries(const void* a, const void* b);		// order of the entries in a book file (by key, then move) for qsort
+uint64_t canonicalKey(uint64_t p, uint64_t o, int* symmetries);	// key shared by the 8 rotations and mirrors of a board
+int canonicalMove(int x, int symmetries);					// the move x in the orientation of the key
+
+// search cache, searchPosition reuses the results of earlier searches of a position, also of earlier runs
+int cacheOpen(const char* file);							// map a cache file (created when missing) and append the new results to it, return 0 when fails
+void cacheClose();											// unmap the cache and close its file
+int cacheProbe(Position* p, SearchLimits* limits, SearchResult* result);	// fill the result from a cached search as good as the limits allow, return 0 if none
+void cacheStore(Position* p, SearchLimits* limits, SearchResult* result);	// keep the result of a search and append it to the file
+
+// transposition table
+uint64_t hashPosition(Position* p);							// compute the zobrist key of a position from scratch
+int hashInit(int mb);										// allocate the table with the size in MB, return 0 when fails
+void hashClear();											// empty the table
+int hashProbe(uint64_t key, HashEntry* e);					// copy the entry of the key into e, return 0 if not found
+void hashStore(uint64_t key, int depth, int bound, int score, int move);	// store a search result with depth-preferred replacement
+
+#endif
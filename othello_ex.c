@@ -15,7 +15,7 @@
 				  for the outter four corners are set to 70, meaning that if we predict the player
 				  makes a move at one of the cornor, the value for the node will be added with -70, 
 				  but if it is the ai does the cornor, the value will be added with 70. This
-				  behavior can be observed in the expendNode function. Based on the observation, 
+				  behavior can be observed in the makeMove function. Based on the observation, 
 				  with this evaluation function and searching implementation, the ai will be the 
 				  most difficult when the depth limit is 2. Any value more than 2 seems to overkill 
 				  the selection. The evaluated values for many future option can easily confuse the 
@@ -27,7 +27,9 @@
 #include <math.h>
 #include <time.h>
 #include <string.h>
+#include <threads.h>
 #include <GL/glut.h>					// GLUT library
+#include "othello_engine.h"				// rules and search of the ai
 
 
 //@@***********************************************************************************@@
@@ -35,73 +37,93 @@
 #define WINDOW_NAME "Othello"			// Window name
 #define WINDOW_XS 712					// Window size
 #define WINDOW_YS 512
-#define BOARD_SIZE 8
 #define RAD_DEG 40
-#define MIN -5000
-#define MAX 5000
-#define WHITE 1
-#define BLACK 2
 #define ANI_MSEC 100
 #define MOVE_INTERVAL 5					// interval between moves in 0.1s
-#define ALPHABETAHEIGHT 2				// Depth for the alpha beta program
+#define QUEUE_SIZE 4					// most requests or results waiting in the queue of the ai worker
+#define PONDER_MSEC 25					// first time slice of each reply of the player when pondering
 
 
 //@@***********************************************************************************@@
 // Structs
 
-// general list
-struct List;
-typedef struct List {
-	int val;
-	struct List* next;
-} List;
-
 // Each block on the board piece, a board contains 64 blocks (if with size 8x8)
 typedef struct block
 {
 	int state;							// 0 = none, 1 = white, 2 = black, 3 = possible move
-	List* directionList;				// list of avaliable directions on the block
 } Block;
 
-// Node for each state
-struct node;
-typedef struct node {
-	int id;								// node id
-	int height;							// current depth for the node
-	int originalMove;					// the original move from depth 0
-	int value;							// the increment step value (part of evaluation)
-	int whiteNum;						// white number of the current node
-	int blackNum;						// black number of the current node
-	int identity;						// 0: ai(max), 1: player(min)
-	int childrenSize;					// number of children (possible move) from the node
-	Block board[BOARD_SIZE][BOARD_SIZE];// the board of the node
-	List* actionList;					// a list that contains of the movable position for the children (next step)
-	struct node *parent;				// pointer points to the parent
-	struct node *children;				// pointer points to a array of children
-} Node;
+// Position that the ui asks the ai worker to search
+typedef struct aiRequest {
+	int id;								// game number when the request was made, results of old games are dropped
+	int ponder;							// 1: search the replies of the player until cancelled
+	WideMask black;						// the circles of the position, the ai (black) to move, or the player when pondering
+	WideMask white;
+} AiRequest;
+
+// Move that the ai worker found for a request
+typedef struct aiResult {
+	int id;								// id of the request
+	int move;							// the best move (r * boardSize + c), -1 if the ai has no move
+} AiResult;
+
+// Answer of the ai to one reply of the player, prepared while pondering
+typedef struct ponderEntry {
+	WideMask black;						// the board after the reply
+	WideMask white;
+	int move;							// the best answer of the ai
+	int msec;							// time slice that the answer was searched with, 0 if not searched
+	int exact;							// 1 when the answer was solved exactly
+} PonderEntry;
+
+// Queue between the ui and the ai worker thread, every field except cancel is guarded by lock
+typedef struct aiQueue {
+	mtx_t lock;
+	cnd_t ready;						// signaled when a request is added or the worker has to quit
+	AiRequest request[QUEUE_SIZE];		// requests waiting for the worker
+	int requestHead;
+	int requestCount;
+	AiResult result[QUEUE_SIZE];		// results waiting for the ui
+	int resultHead;
+	int resultCount;
+	int gameId;							// current game number
+	int quit;							// set when the worker has to quit
+	int pondering;						// set while the worker ponders
+	PonderEntry ponder[MAX_BOARD_SIZE * MAX_BOARD_SIZE];	// prepared answer for each reply of the player
+	atomic_int cancel;					// stops the running search, read by the search threads
+} AiQueue;
 
 //@@***********************************************************************************@@
 // Global variables
 
-Block board[BOARD_SIZE][BOARD_SIZE];	// the main board that the user is playing on
+int boardSize = BOARD_SIZE;				// blocks on a side, 6, 8 or 10
+int cellSize;							// size of a block in pixels
+const SizeKernels* kernels;				// rules and search of the board size
+Block board[MAX_BOARD_SIZE][MAX_BOARD_SIZE];	// the main board that the user is playing on
+WideMask blackCircles;					// the bitboards of the board, kept move by move
+WideMask whiteCircles;
+WideMask shownMoves;					// the blocks marked as possible moves (state 3) on the board
 
 int playersColor;						// players perspective (1: white, 2: black)
 int aisColor;							// ai's perspective (1: white, 2: black)
 int whiteNum;							// white number on the current board
 int blackNum;							// black number on the current board
-int bestMove;							// a variable that uses to capture the best move during search
-int nodeID;								// a variable that uses to count and assign the node id for each node created during search
+SearchLimits limits;					// limits of the search of every ai move
+int searchVerbose;						// print the search result of every ai move in the terminal
+int ponderEnabled = 1;					// search the player's turn while waiting for the click
+FILE* searchLog;						// the statistics of every ai move are appended to it as JSON lines, NULL if not used
 int gameState;							// 1: players turn, 2: ais turn, 3: gameover
 int aisturn;
 int aTimer;
+int aiThinking;							// 1 when a request is sent to the ai worker and its result has not arrived
+AiQueue aiQueue;						// requests and results of the ai worker
+thrd_t aiThread;						// the ai worker
 
 int restartButtonX = 538;				// x value of the restart button
 int restartButtonY = 50;				// y value of the restart button
 int buttonHeight = 30;					// height of the button
 int buttonWidth = 150;					// width of the button
 
-List* tempActionList;					// list that uses to capture the action list during the search
-
 //@@***********************************************************************************@@
 // Function
 
@@ -117,33 +139,99 @@ void reshape_handler(int width, int height);
 void reset();												// reset the game
 void swapColors();											// swap the players and ai's perspective
 void setColors(int mode);									// mode 0: player is white, mode 1: player is black
-void stateReset(Block b[BOARD_SIZE][BOARD_SIZE]);			// reset all state 3 to state 0 and delete all direction list
-int aiMove();												// trigger alpha beta search
-int getPosition(int x, int y);								// will return 0 - 63
-int getMoveValue(int r, int c);								// part of evaluation, will be added to the node when the node is created
-int boardScan(Block b[BOARD_SIZE][BOARD_SIZE], int mode);	// mode 0: normal mode, mode 1: search mode 
-int flip(Block b[BOARD_SIZE][BOARD_SIZE], int r, int c);	// place the circle in a specific block and flip the circles
-int checkDirection(Block b[BOARD_SIZE][BOARD_SIZE], int r, int c, int direction); // check if a move on a specific position will be vaild to flip in a specific direction
-
-void displayList(List* h, int mode);						// display the list information in the console (mode 1: displyDirection, mode 2: displayAction)
-List* deleteList(List* h);									// delete the list 
-List* addToListFront(List*h, int d);						// add a value to the front of the list
-List* listClone(List* sourceList, List* targetList);		// clone a list to another list
-
-int maxValue(Node* n, int alpha, int beta, float h);		// half of the alpha-beta search function
-int minValue(Node* n, int alpha, int bate, float h);		// another half of the alpha-beta search function
-
-void expendNode(Node* n);									// expend a node and initialize the childrens' value
-void destroyTree(Node* n);									// destroy the root node and all of its children
-void displayNode(Node* n);									// display a node's information in the terminal
-
-void displayBoard(Block b[BOARD_SIZE][BOARD_SIZE]);			// visualize the board in the terminal
+void stateReset(Block b[MAX_BOARD_SIZE][MAX_BOARD_SIZE]);	// reset the marked state 3 to state 0
+int aiMove(WideMask black, WideMask white);					// trigger alpha beta search
+void playAiMove(int m);										// play the move of the ai on the board, -1 if the ai passes
+int getPosition(int x, int y);								// will return 0 - boardSize * boardSize - 1
+int boardScan(Block b[MAX_BOARD_SIZE][MAX_BOARD_SIZE], int mode);	// mode 0: normal mode, mode 1: search mode
+int flip(Block b[MAX_BOARD_SIZE][MAX_BOARD_SIZE], int r, int c);	// place the circle in a specific block and flip the circles
+void gameToBits(int color, WideMask* player, WideMask* opponent);	// the bitboards of the game with color as the side to move
+
+void displayBoard(Block b[MAX_BOARD_SIZE][MAX_BOARD_SIZE]);	// visualize the board in the terminal
+
+// ai worker functions, the search runs on its own thread so the window keeps drawing
+int workerStart();											// set up the queue and start the worker, return 0 when fails
+void workerStop();											// cancel the search and wait for the worker to quit
+int aiWorker(void* arg);									// thread entry of the worker
+void requestAiMove();										// send the current board to the worker
+void requestPonder();										// let the worker search the player's turn until the player moves
+void ponder(WideMask black, WideMask white);				// search every reply of the player with growing time slices
+int pollAiMove(int* m);										// take the result of the current game, return 0 if not ready
+void cancelAiMove();										// drop the requests of the current game and stop its search
 
 //@@***********************************************************************************@@
 int main(int argc, char **argv)
 {
 	glutInit(&argc, argv);
 
+	// optional arguments: -hash <MB>, -time <ms>, -depth <max depth>, -threads <n>, -endgame <empties>, -v (print the searches),
+	// -noponder (do not search while the player thinks), -log <file> (append the statistics of every ai move as JSON),
+	// -eval <file> (weights of the pattern evaluation, PATTERN_FILE is tried when it is not given),
+	// -book <file> (opening book, BOOK_FILE is tried when it is not given), -nobook,
+	// -cache <file> (reuse and keep the deep and exact searches in the file, also for the next games and runs),
+	// -probcut <file> (multi-probcut parameters, PROBCUT_FILE is tried when it is not given), -selectivity <sigmas> (0: off),
+	// -size <n> (a board of 6x6, 8x8 or 10x10 blocks, the sizes other than 8 are played without the table, the weights, the book and the cache)
+	int hashMB = HASH_MB;
+	char* evalFile = NULL;
+	char* probcutFile = NULL;
+	char* bookFile = NULL;
+	int useBook = 1;
+	char* cacheFile = NULL;
+	defaultLimits(&limits);
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "-v") == 0) searchVerbose = 1;
+		else if (strcmp(argv[i], "-noponder") == 0) ponderEnabled = 0;
+		else if (strcmp(argv[i], "-nobook") == 0) useBook = 0;
+		else if (i + 1 >= argc) break;
+		else if (strcmp(argv[i], "-hash") == 0) hashMB = atoi(argv[++i]);
+		else if (strcmp(argv[i], "-time") == 0) limits.msec = atoi(argv[++i]);
+		else if (strcmp(argv[i], "-depth") == 0) limits.maxDepth = atoi(argv[++i]);
+		else if (strcmp(argv[i], "-threads") == 0) limits.threads = atoi(argv[++i]);
+		else if (strcmp(argv[i], "-endgame") == 0) limits.endgameEmpties = atoi(argv[++i]);
+		else if (strcmp(argv[i], "-eval") == 0) evalFile = argv[++i];
+		else if (strcmp(argv[i], "-probcut") == 0) probcutFile = argv[++i];
+		else if (strcmp(argv[i], "-selectivity") == 0) limits.probcut = atof(argv[++i]);
+		else if (strcmp(argv[i], "-book") == 0) bookFile = argv[++i];
+		else if (strcmp(argv[i], "-cache") == 0) cacheFile = argv[++i];
+		else if (strcmp(argv[i], "-size") == 0) boardSize = atoi(argv[++i]);
+		else if (strcmp(argv[i], "-log") == 0 && !(searchLog = fopen(argv[++i], "a"))) {
+			printf("Cannot open %s.\n", argv[i]);
+			return 1;
+		}
+	}
+	if (!engineInit(hashMB)) {
+		printf("Cannot allocate %d MB for the transposition table.\n", hashMB);
+		return 1;
+	}
+	if (!(kernels = sizeSelect(boardSize))) {
+		printf("The board size %d is not supported, use 6, 8 or 10.\n", boardSize);
+		return 1;
+	}
+	cellSize = WINDOW_YS / boardSize;
+	if (!evalFile) patternLoad(PATTERN_FILE);					// the default weights are optional
+	else if (!patternLoad(evalFile)) {
+		printf("Cannot load the weights from %s.\n", evalFile);
+		return 1;
+	}
+	if (!probcutFile) probcutLoad(PROBCUT_FILE);				// the default parameters are optional
+	else if (!probcutLoad(probcutFile)) {
+		printf("Cannot load the multi-probcut parameters from %s, or they were fitted with another evaluation.\n", probcutFile);
+		return 1;
+	}
+	if (useBook && !bookFile) bookOpen(BOOK_FILE);				// the default book is optional
+	else if (useBook && !bookOpen(bookFile)) {
+		printf("Cannot open the book %s.\n", bookFile);
+		return 1;
+	}
+	if (cacheFile && !cacheOpen(cacheFile)) {
+		printf("Cannot open the cache %s, or it was made with another evaluation.\n", cacheFile);
+		return 1;
+	}
+	if (!workerStart()) {
+		printf("Cannot start the ai worker.\n");
+		return 1;
+	}
+
 	init_setup(WINDOW_XS, WINDOW_YS, WINDOW_NAME);
 
 	reset();
@@ -185,23 +273,24 @@ void display_func(void)
 	glClearColor(0.2f, 0.2f, 0.2f, 1.0f);			// background color
 	glClear(GL_COLOR_BUFFER_BIT);					// clearing the buffer not to keep the color
 
-	// draw the grids for the puzzle board
+	// draw the grids for the puzzle board, from the top left corner of the window
+	int side = cellSize * boardSize;
 	glColor3f(0.5, 0.5, 0.5);		
 	glBegin(GL_LINES);
-	for (int i = 0; i <= WINDOW_YS; i += WINDOW_YS / BOARD_SIZE)
+	for (int i = 0; i <= side; i += cellSize)
 	{
-		glVertex2i(i, 0);		
+		glVertex2i(i, WINDOW_YS - side);		
 		glVertex2i(i, WINDOW_YS);
-		glVertex2i(0, i);
-		glVertex2i(WINDOW_YS, i);
+		glVertex2i(0, WINDOW_YS - i);
+		glVertex2i(side, WINDOW_YS - i);
 	}
 	glEnd();
 
 	// draw circles
-	for (int i = 0; i < BOARD_SIZE; i++) {
-		for (int j = 0; j < BOARD_SIZE; j++) {
+	for (int i = 0; i < boardSize; i++) {
+		for (int j = 0; j < boardSize; j++) {
 			if (board[j][i].state != 0) {
-				int radius = 25;
+				int radius = cellSize * 25 / 64;
 				if (board[j][i].state == 1) {		// white circle 
 					glColor3f(1, 1, 1);
 				}
@@ -209,13 +298,13 @@ void display_func(void)
 					glColor3f(0, 0, 0);
 				}
 				else if (board[j][i].state == 3) {	// possible move circle
-					radius = 5;
+					radius = cellSize * 5 / 64;
 					glColor3f(0, 0.9, 0.9);
 				}
 				glBegin(GL_POLYGON); // Circle at center of field
 				for (float ang = 0.0; ang < 360.0; ang += 10.0) {
-					float x = radius * cos(ang / RAD_DEG) + 32 + i * 64;
-					float y = radius * sin(ang / RAD_DEG) + WINDOW_YS - 32 - j * 64;
+					float x = radius * cos(ang / RAD_DEG) + cellSize / 2 + i * cellSize;
+					float y = radius * sin(ang / RAD_DEG) + WINDOW_YS - cellSize / 2 - j * cellSize;
 					glVertex2f(x, y);
 				}
 				glEnd();
@@ -230,10 +319,10 @@ void display_func(void)
 	output(552, 435, 3, "CS4200/5200");
 	output(552, 415, 3, "Che Shian Hung");
 	output(552, 340, 3, "white num: ");
-	snprintf(str, 3, "%d", whiteNum);
+	snprintf(str, sizeof(str), "%d", whiteNum);
 	output(660, 340, 3, str);
 	output(552, 320, 3, "black num: ");
-	snprintf(str, 3, "%d", blackNum);
+	snprintf(str, sizeof(str), "%d", blackNum);
 	output(660, 320, 3, str);
 	if (gameState == 3) {							// when game is over
 		if (whiteNum > blackNum) {
@@ -273,15 +362,8 @@ void keyboard_func(unsigned char c, int x, int y)
 	// quit the program
 	case 'Q':
 	case 'q':
-		// delete pointers
-		tempActionList = NULL;
-		for (int i = 0; i < BOARD_SIZE; i++) {
-			for (int j = 0; j < BOARD_SIZE; j++) {
-				board[i][j].directionList = deleteList(board[i][j].directionList);
-			}
-		}
-
 		printf("Good Bye !\n");
+		workerStop();
 		exit(0);		
 	}
 }
@@ -290,11 +372,11 @@ void keyboard_func(unsigned char c, int x, int y)
 void mouse_func(int button, int state, int x, int y)
 {
 	// when click on the board
-	if (state == GLUT_DOWN && x < WINDOW_YS) {
+	if (state == GLUT_DOWN && x < cellSize * boardSize && y < cellSize * boardSize) {
 		// get block position
 		int position = getPosition(x, y);
-		int r = position / BOARD_SIZE;
-		int c = position % BOARD_SIZE;
+		int r = position / boardSize;
+		int c = position % boardSize;
 
 		// if the block is a valid and game is not over
 		if (board[r][c].state == 3 && gameState != 3) {
@@ -325,48 +407,16 @@ void mouse_func(int button, int state, int x, int y)
 //@@***********************************************************************************@@
 void animation_func(int val) {
 	if (aisturn == 1) {
+		int m;
+		if (!aiThinking) {											// the ai searches while the move interval passes
+			requestAiMove();
+			aiThinking = 1;
+		}
 		if (aTimer < MOVE_INTERVAL) aTimer++;
-		else {
-			int m = aiMove();										// ai's turn
-			int flipNum;
-			if (m == -1) {											// if no move for ai
-				int move = boardScan(board, 0);						// scan the board for ai
-				if (move == 0) gameState = 3;						// if the game is over
-				else if (move == 2) {								// no valid move for ai but the game is not finished
-					setColors(0);									// change to player's perspectivce
-					boardScan(board, 0);							// scan the board for player
-				}
-			}
-			else {													// if there is at least a possible move for ai
-				setColors(1);										// change to ai's perspective
-				boardScan(board, 2);								// scan the board for ai
-
-																	// make ai's move and flip
-				flipNum = flip(board, m / BOARD_SIZE, m % BOARD_SIZE);
-				whiteNum -= flipNum;
-				blackNum += flipNum + 1;
-
-				swapColors();										// switch to player's perspective
-				int move = boardScan(board, 0);						// scan the board for ai
-				if (move == 0) gameState = 3;						// if the game is over
-				else if (move == 2) {								// no valid move for ai but the game is not finished
-					int m = aiMove();								// ai's turn
-					setColors(1);									// change to ai's perspective 
-					boardScan(board, 2);							// scan the board for ai
-
-																	// make ai's move and flip
-					flipNum = flip(board, m / BOARD_SIZE, m % BOARD_SIZE);
-					whiteNum -= flipNum;
-					blackNum += flipNum + 1;
-
-					swapColors();									// switch to player's perspective	
-					int m2 = boardScan(board, 0);					// scan the board for the player
-					if (m2 == 0 || m2 == 2) {						// if the game is over 
-						gameState = 3;
-					}
-				}
-			}
+		else if (pollAiMove(&m)) {									// ai's turn, play once the worker is done
+			aiThinking = 0;
 			aisturn = 0;
+			playAiMove(m);
 		}
 	}
 
@@ -410,21 +460,22 @@ void reset() {
 	whiteNum = 2;
 	blackNum = 2;
 	aisturn = 0;
+	aiThinking = 0;
+	cancelAiMove();												// the search of the old game is no longer needed
 	setColors(0);
-	for (int i = 0; i < BOARD_SIZE; i++) {
-		for (int j = 0; j < BOARD_SIZE; j++) {
-			if (i == j && (i == 3 || i == 4)) board[i][j].state = 1;
-			else if ((i == 3 && j == 4) || (i == 4 && j == 3)) board[i][j].state = 2;
-			else board[i][j].state = 0;
-			board[i][j].directionList = deleteList(board[i][j].directionList);
-		}
+	blackCircles = kernels->startBlack;							// the player (white) moves first
+	whiteCircles = kernels->startWhite;
+	for (int x = 0; x < boardSize * boardSize; x++) {
+		WideMask m = (WideMask)1 << x;
+		board[x / boardSize][x % boardSize].state = (blackCircles & m) ? 2 : ((whiteCircles & m) ? 1 : 0);
 	}
+	shownMoves = 0;
 }
 
 //@@***********************************************************************************@@
 // get the position from the x-y coordinates
 int getPosition(int x, int y) {
-	return y / (WINDOW_YS / BOARD_SIZE) * BOARD_SIZE + x / (WINDOW_YS / BOARD_SIZE);
+	return y / cellSize * boardSize + x / cellSize;
 }
 
 //@@***********************************************************************************@@
@@ -451,722 +502,301 @@ void setColors(int mode) {
 }
 
 //@@***********************************************************************************@@
-// set the state 3 to state 0 from the board and delete all direction lists
-void stateReset(Block b[BOARD_SIZE][BOARD_SIZE]) {
-	for (int i = 0; i < BOARD_SIZE; i++) {
-		for (int j = 0; j < BOARD_SIZE; j++) {
-			if (b[i][j].state == 3) b[i][j].state = 0;
-			if(b[i][j].directionList) b[i][j].directionList = deleteList(b[i][j].directionList);
-		}
+// set the state 3 to state 0 on the blocks marked by the last scan, the other blocks are not visited
+void stateReset(Block b[MAX_BOARD_SIZE][MAX_BOARD_SIZE]) {
+	for (WideMask m = shownMoves; m; m &= m - 1) {
+		int x = wideLowestBit(m);
+		if (b[x / boardSize][x % boardSize].state == 3) b[x / boardSize][x % boardSize].state = 0;
 	}
+	shownMoves = 0;
 }
 
 //@@***********************************************************************************@@
-// get the evaluated value from a specific block when a move is made
-int getMoveValue(int r, int c) {
-	// in the center 4 x 4 area
-	if (r >= 2 && r <= 5 && c >= 2 && c <= 5) return 0;
-	// inner four sides except corners
-	else if (((r == 1 || r == 6) && c >= 2 && c <= 5) || ((c == 1 || c == 6) && r >= 2 && r <= 5)) return -30;
-	// inner corners
-	else if ((r == c && (r == 1 || r == 6)) || (r == 1 && c == 6) || (r == 6 && c == 1)) return -50;
-	// outer corers
-	else if ((r == c && (r == 0 || r == 7)) || (r == 0 && c == 7) || (r == 7 && c == 0)) return 70;
-	// blocks next to four cornors
-	else if (r == 1 || r == 6 || c == 1 || c == 6) return -30;
-	// outer four sides 
-	else return 50;
-}
-
-//@@***********************************************************************************@@
-// make a move in a specific block and flip the circles
-int flip(Block b[BOARD_SIZE][BOARD_SIZE], int r, int c) {
-	int flipNum = 0;												// number of circles fliped
-	
-	int originalR = r;
-	int originalC = c;
-	List* temp = b[r][c].directionList;								// read the direction list from the block
-
-	while (temp) {
-		switch (temp->val) {
-		// up
-		case 0:
-			r -= 2;													// start checking from the second circle since the first one is correct for sure
-			while (r >= 0) {
-				if (b[r][c].state == playersColor) {				// if we found the player's circle, flip the circles in between
-					b[originalR][c].state = playersColor;
-					r++;
-					while (r < originalR) {	
-						b[r][c].state = playersColor;
-						r++;
-						flipNum++;
-					}
-					break;
-				}
-				else
-					r--;
-			}
-			break;
-		// right up
-		case 1:
-			r -= 2;
-			c += 2;
-			while (r >= 0 && c < BOARD_SIZE) {
-				if (b[r][c].state == playersColor) {
-					b[originalR][originalC].state = playersColor;
-					r++;
-					c--;
-					while (r < originalR) {
-						b[r][c].state = playersColor;
-						r++;
-						c--;
-						flipNum++;
-					}
-					break;
-				}
-				else {
-					r--;
-					c++;
-				}
-			}
-			break;
-		// right
-		case 2:
-			c += 2;
-			while (c < BOARD_SIZE) {
-				if (b[r][c].state == playersColor) {
-					b[r][originalC].state = playersColor;
-					c--;
-					while (c > originalC) {
-						b[r][c].state = playersColor;
-						c--;
-						flipNum++;
-					}
-					break;
-				}
-				else
-					c++;
-			}
-			break;
-		// right down
-		case 3:
-			r += 2;
-			c += 2;
-			while (r < BOARD_SIZE && c < BOARD_SIZE) {
-				if (b[r][c].state == playersColor) {
-					b[originalR][originalC].state = playersColor;
-					r--;
-					c--;
-					while (c > originalC) {
-						b[r][c].state = playersColor;
-						r--;
-						c--;
-						flipNum++;
-					}
-					break;
-				}
-				else {
-					r++;
-					c++;
-				}
-			}
-			break;
-		// down
-		case 4:
-			r += 2;
-			while (r < BOARD_SIZE) {
-				if (b[r][c].state == playersColor) {
-					b[originalR][c].state = playersColor;
-					r--;
-					while (r > originalR) {
-						b[r][c].state = playersColor;
-						r--;
-						flipNum++;
-					}
-					break;
-				}
-				else
-					r++;
-			}
-			break;
-			// left down
-		case 5:
-			r += 2;
-			c -= 2;
-			while (r < BOARD_SIZE && c >= 0) {
-				if (b[r][c].state == playersColor) {
-					b[originalR][originalC].state = playersColor;
-					r--;
-					c++;
-					while (r > originalR) {
-						b[r][c].state = playersColor;
-						r--;
-						c++;
-						flipNum++;
-					}
-					break;
-				}
-				else {
-					r++;
-					c--;
-				}
-			}
-			break;
-			// left
-		case 6:
-			c -= 2;
-			while (c >= 0) {
-				if (b[r][c].state == playersColor) {
-					b[r][originalC].state = playersColor;
-					c++;
-					while (c < originalC) {
-						b[r][c].state = playersColor;
-						c++;
-						flipNum++;
-					}
-					break;
-				}
-				else
-					c--;
-			}
-			break;
-			// left up
-		case 7:
-			r -= 2;
-			c -= 2;
-			while (c >= 0 && r >= 0) {
-				if (b[r][c].state == playersColor) {
-					b[originalR][originalC].state = playersColor;
-					r++;
-					c++;
-					while (r < originalR) {
-						b[r][c].state = playersColor;
-						r++;
-						c++;
-						flipNum++;
-					}
-					break;
-				}
-				else {
-					r--;
-					c--;
-				}
-			}
-			break;
-		default:															// exception
-			printf("Unrecongnized value passed into flipDirection function.\n");
-			break;
-		}
-		// reset the variables and look for next direction
-		r = originalR;
-		c = originalC;
-		temp = temp->next;
+// make a move in a specific block and flip the circles, the game plays the move and only the new
+// circle and the flipped circles are written to the board
+int flip(Block b[MAX_BOARD_SIZE][MAX_BOARD_SIZE], int r, int c) {
+	WideMask* own = playersColor == BLACK ? &blackCircles : &whiteCircles;
+	WideMask* other = playersColor == BLACK ? &whiteCircles : &blackCircles;
+	WideMask m = (WideMask)1 << (r * boardSize + c);
+	WideMask flips = kernels->flips(*own, *other, r * boardSize + c);
+	*own |= flips | m;
+	*other &= ~flips;
+
+	b[r][c].state = playersColor;
+	shownMoves &= ~m;
+	for (WideMask f = flips; f; f &= f - 1) {					// write every flipped circle back to the board
+		int x = wideLowestBit(f);
+		b[x / boardSize][x % boardSize].state = playersColor;
 	}
-	b[r][c].directionList = deleteList(b[r][c].directionList);				// delete the directionList
 
-	return flipNum;
+	return widePopCount(flips);
 }
 
 //@@***********************************************************************************@@
 // Mode 0 (player mode) => return 0: board is full, 1: next move available, 2: no avaliable move but the board is not full
 // Mode 1 (ai mode) => return # of children
 // Mode 2 (flip ai mode) => not show availabe moves
-int boardScan(Block b[BOARD_SIZE][BOARD_SIZE], int mode) {
-	int isFull = 1;															// assume the board is full
-	int childNum = 0;														// children counter
+int boardScan(Block b[MAX_BOARD_SIZE][MAX_BOARD_SIZE], int mode) {
 	int nextMoveAvaliable = 0;
 
-	stateReset(b);															// reset board state
-
-	if (mode == 1) tempActionList = NULL;									// initialize tempActionList
-
-	// scane thorugh each block
-	for (int r = 0; r < BOARD_SIZE; r++) {
-		for (int c = 0; c < BOARD_SIZE; c++) {
-			if (b[r][c].state == 0) {										// if the block is empty
-				int movable = 0;											// if the block is a possible move
-				if (isFull == 1) isFull = 0;								// the board is not full anymore
-
-				// check all neighbors, if any surrounding neighbor is aisColor, check the direction from the neightbor
-				// up
-				if (r - 1 >= 0) {
-					if (b[r - 1][c].state == aisColor) {
-						int check = checkDirection(b, r, c, 0);
-						if (check == 1) {									// if the block is a valid move in the direction
-							b[r][c].directionList = addToListFront(b[r][c].directionList, 0); // add the direction to the direction list
-							if (movable == 0) movable = 1;					// the block is movable 
-						}
-					}
-				}
-				// up right
-				if (r - 1 >= 0 && c + 1 < BOARD_SIZE) {
-					if (b[r - 1][c + 1].state == aisColor) {
-						int check = checkDirection(b, r, c, 1);
-						if (check == 1) {
-							b[r][c].directionList = addToListFront(b[r][c].directionList, 1);
-							if (movable == 0) movable = 1;
-						}
-					}
-				}
-				// right
-				if (c + 1 < BOARD_SIZE) {
-					if (b[r][c + 1].state == aisColor) {
-						int check = checkDirection(b, r, c, 2);
-						if (check == 1) {
-							b[r][c].directionList = addToListFront(b[r][c].directionList, 2);
-							if (movable == 0) movable = 1;
-						}
-					}
-				}
-				// down right
-				if (r + 1 < BOARD_SIZE && c + 1 < BOARD_SIZE) {
-					if (b[r + 1][c + 1].state == aisColor) {
-						int check = checkDirection(b, r, c, 3);
-						if (check == 1) {
-							b[r][c].directionList = addToListFront(b[r][c].directionList, 3);
-							if (movable == 0) movable = 1;
-						}
-					}
-				}
-				// down
-				if (r + 1 < BOARD_SIZE) {
-					if (b[r + 1][c].state == aisColor) {
-						int check = checkDirection(b, r, c, 4);
-						if (check == 1) {
-							b[r][c].directionList = addToListFront(b[r][c].directionList, 4);
-							if (movable == 0) movable = 1;
-						}
-					}
-				}
-				// left down
-				if (r + 1 < BOARD_SIZE && c - 1 >= 0) {
-					if (b[r + 1][c - 1].state == aisColor) {
-						int check = checkDirection(b, r, c, 5);
-						if (check == 1) {
-							b[r][c].directionList = addToListFront(b[r][c].directionList, 5);
-							if (movable == 0) movable = 1;
-						}
-					}
-				}
-				// left
-				if (c - 1 >= 0) {
-					if (b[r][c - 1].state == aisColor) {
-						int check = checkDirection(b, r, c, 6);
-						if (check == 1) {
-							b[r][c].directionList = addToListFront(b[r][c].directionList, 6);
-							if (movable == 0) movable = 1;
-						}
-					}
-				}
-				// left up
-				if (r - 1 >= 0 && c - 1 >= 0) {
-					if (b[r - 1][c - 1].state == aisColor) {
-						int check = checkDirection(b, r, c, 7);
-						if (check == 1) {
-							b[r][c].directionList = addToListFront(b[r][c].directionList, 7);
-							if (movable == 0) movable = 1;
-						}
-					}
-				}
-				// change block state
-				if (movable == 1) {	
-					childNum++;
-					if(mode != 2) b[r][c].state = 3;
-					if (mode == 1) {
-						tempActionList = addToListFront(tempActionList, r * 8 + c);
-					}
-				}
-				if (movable == 1) nextMoveAvaliable = 1;					// if the block is valid for the next move, we do not need to skip a step
-				else if (b[r][c].directionList) {							// if there is no move and there are values in the direction list, delete the list
-					b[r][c].directionList = deleteList(b[r][c].directionList); 
-				}
-			}
+	WideMask player, opponent;
+	gameToBits(playersColor, &player, &opponent);
+	WideMask moves = kernels->moves(player, opponent);					// every valid move at once
+
+	if (mode == 1) return widePopCount(moves);								// mode 1: return # of possible moves
+	if (mode == 2) stateReset(b);											// mode 2: no marks on the board
+	else {																	// only the blocks that changed their mark are visited
+		for (WideMask m = shownMoves & ~moves; m; m &= m - 1) {
+			int x = wideLowestBit(m);
+			if (b[x / boardSize][x % boardSize].state == 3) b[x / boardSize][x % boardSize].state = 0;
 		}
+		for (WideMask m = moves & ~shownMoves; m; m &= m - 1) {
+			int x = wideLowestBit(m);
+			b[x / boardSize][x % boardSize].state = 3;
+		}
+		shownMoves = moves;
 	}
-	if (isFull == 1) nextMoveAvaliable = 0;									// the board is completely full
-	else if (nextMoveAvaliable != 1) nextMoveAvaliable = 2;					// if no move available but the board is not full yet
-	if(mode != 1) return nextMoveAvaliable;									// mode 0 & mode 2: return the avaliability for the next move
-	else return childNum;													// mode 1: return # of possible moves 
+
+	if (widePopCount(player | opponent) == boardSize * boardSize) nextMoveAvaliable = 0;	// the board is completely full
+	else if (moves) nextMoveAvaliable = 1;									// the side to move can play
+	else nextMoveAvaliable = 2;												// if no move available but the board is not full yet
+	return nextMoveAvaliable;												// mode 0 & mode 2: return the avaliability for the next move
 }
 
 //@@***********************************************************************************@@
-// check if a block is a valid move from a specific direction
-int checkDirection(Block b[BOARD_SIZE][BOARD_SIZE], int r, int c, int direction) {
-	switch (direction) {
-	// up
-	case 0:
-		r -= 2;																// check the second to save performance
-		while (r >= 0 && b[r][c].state != 0 && b[r][c].state != 3) {		// if next block is not empty or a hint block and in bound
-			if (b[r][c].state == playersColor) {							// if the block has players circle
-				return 1;													// the block is valid
-			}
-			else
-				r--;
-		}
-		break;
-	// right up
-	case 1:
-		r -= 2;
-		c += 2;
-		while (r >= 0 && c < BOARD_SIZE && b[r][c].state != 0 && b[r][c].state != 3) {
-			if (b[r][c].state == playersColor) {
-				return 1;
-			}
-			else {
-				r--;
-				c++;
-			}
-		}
-		break;
-	// right
-	case 2:
-		c += 2;
-		while (c < BOARD_SIZE && b[r][c].state != 0 && b[r][c].state != 3) {
-			if (b[r][c].state == playersColor) {
-				return 1;
-			}
-			else
-				c++;
-		}
-		break;
-	// right down
-	case 3:
-		r += 2;
-		c += 2;
-		while (r < BOARD_SIZE && c < BOARD_SIZE && b[r][c].state != 0 && b[r][c].state != 3) {
-			if (b[r][c].state == playersColor) {
-				return 1;
-			}
-			else {
-				r++;
-				c++;
-			}
-		}
-		break;
-	// down
-	case 4:
-		r += 2;
-		while (r < BOARD_SIZE && b[r][c].state != 0 && b[r][c].state != 3) {
-			if (b[r][c].state == playersColor) {
-				return 1;
-			}
-			else
-				r++;
-		}
-		break;
-	// left down
-	case 5:
-		r += 2;
-		c -= 2;
-		while (r < BOARD_SIZE && c >= 0 && b[r][c].state != 0 && b[r][c].state != 3) {
-			if (b[r][c].state == playersColor) {
-				return 1;
-			}
-			else {
-				r++;
-				c--;
-			}
-		}
-		break;
-	// left
-	case 6:
-		c -= 2;
-		while (c >= 0 && b[r][c].state != 0 && b[r][c].state != 3) {
-			if (b[r][c].state == playersColor) {
-				return 1;
-			}
-			else
-				c--;
-		}
-		break;
-	// left up
-	case 7:
-		r -= 2;
-		c -= 2;
-		while (c >= 0 && r >= 0 && b[r][c].state != 0 && b[r][c].state != 3) {
-			if (b[r][c].state == playersColor) {
-				return 1;
-			}
-			else {
-				r--;
-				c--;
-			}
-		}
-		break;
-	// exception
-	default:
-		printf("Unrecongnized value passed into flipDirection function.\n");
-		break;
-	}
-	return 0;
+// the bitboards of the game with color as the side to move, read from the game without a scan of the board
+void gameToBits(int color, WideMask* player, WideMask* opponent) {
+	*player = color == BLACK ? blackCircles : whiteCircles;
+	*opponent = color == BLACK ? whiteCircles : blackCircles;
 }
 
 //@@***********************************************************************************@@
-// ai's turn, trigger the alpha beta search if doable
-int aiMove() {
-	// initialize variables
-	nodeID = 0;
-	bestMove = -1;
-
-	// create root
-	Node* r = (Node*)malloc(sizeof(Node));
-	r->id = nodeID;
-	r->height = 0;
-	r->originalMove = -1;
-	r->value = 0;
-	r->whiteNum = whiteNum;
-	r->blackNum = blackNum;
-	r->identity = 0;
-	r->childrenSize = 0;
-	for (int i = 0; i < BOARD_SIZE; i++) {
-		for (int j = 0; j < BOARD_SIZE; j++) {
-			r->board[i][j].state = board[i][j].state;
-			r->board[i][j].directionList = NULL;
-		}
+// search the position with the ai to move, runs on the worker thread
+int aiMove(WideMask black, WideMask white) {
+	SearchResult result;
+	int bestMove = kernels->search(black, white, 0, &limits, &result);
+	if (searchVerbose && bestMove != -1 && !atomic_load(&aiQueue.cancel)) {
+		printf("ai move %d score %d depth %d%s%s nodes %lld msec %lld threads %d researches %d fail highs %d fail lows %d\n",
+			bestMove, result.score, result.depth, result.exact ? " exact" : (result.book ? " book" : ""),
+			result.cached ? " cached" : "", result.nodes, result.msec, result.threads,
+			result.counters.researches, result.counters.failHighs, result.counters.failLows);
 	}
-	r->actionList = NULL;
-	r->parent = NULL;
-	r->children = NULL;
-
-	// check current
-	setColors(1); // black
-	r->childrenSize = boardScan(r->board, 1);							// 0: board is full, 1: next move available, 2: no avaliable move but the board is not full
-	r->actionList = tempActionList;
-	tempActionList = NULL;
-
-	// if there is children
-	if (r->childrenSize > 0) {
-		int value = maxValue(r, MIN, MAX, 0.0f);
-	}
-
-	// destroy the tree
-	destroyTree(r);
+	if (searchLog && bestMove != -1 && !atomic_load(&aiQueue.cancel)) writeSearchJson(searchLog, &result);
 
 	// return the position for the next move
 	return bestMove;
 }
 
 //@@***********************************************************************************@@
-// return the action with the highest evaluation value
-int maxValue(Node* n, int alpha, int beta, float h) {
-	if (n->childrenSize == 0 || h >= ALPHABETAHEIGHT)					// when the node cannot be expend or reach the depth limit
-		return n->value + (n->blackNum - n->whiteNum);
-	int v = MIN;
-	expendNode(n);
-	for (int i = 0; i < n->childrenSize; i++) {
-		int min = minValue(&n->children[i], alpha, beta, h + 1);
-		if (min > v) v = min;
-		if (v >= beta) return v;										// pruning
-		if (alpha < v) {												// update alpha
-			alpha = v;
-			bestMove = n->children[i].originalMove;						// record the move
-		}
+// play the move of the ai on the board and hand the turn to the player. When the player has no move
+// the ai moves again, the game is over when neither side can move
+void playAiMove(int m) {
+	if (m == -1) {												// if no move for ai
+		setColors(0);											// change to player's perspectivce
+		int move = boardScan(board, 0);							// scan the board for player
+		if (move != 1) gameState = 3;							// if the game is over
+		return;
 	}
-	return v;
-}
 
-//@@***********************************************************************************@@
-// return the action with the lowest evaluation value
-int minValue(Node* n, int alpha, int beta, float h) {
-	if (n->childrenSize == 0 || h >= ALPHABETAHEIGHT)					// when the node cannot be expend or reach the depth limit
-		return n->value + (n->blackNum - n->whiteNum);
-	int v = MAX;
-	expendNode(n);
-	for (int i = 0; i < n->childrenSize; i++) {
-		int max = maxValue(&n->children[i], alpha, beta, h + 1);
-		if (max < v) v = max;
-		if (v <= alpha) return v;										// pruning
-		if (beta > v) beta = v;											// update beta
+	setColors(1);												// change to ai's perspective
+	boardScan(board, 2);										// scan the board for ai
+
+	// make ai's move and flip
+	int flipNum = flip(board, m / boardSize, m % boardSize);
+	whiteNum -= flipNum;
+	blackNum += flipNum + 1;
+
+	swapColors();												// switch to player's perspective
+	int move = boardScan(board, 0);								// scan the board for the player
+	if (move == 0) gameState = 3;								// if the game is over
+	else if (move == 2) {										// no valid move for the player but the game is not finished
+		aTimer = MOVE_INTERVAL;									// ai's turn again
+		aisturn = 1;
 	}
-	return v;
+	else if (ponderEnabled) requestPonder();					// think on the player's time
 }
 
 //@@***********************************************************************************@@
-// expend the node and initialize its childrens' values
-void expendNode(Node* n) {
-	if (n->childrenSize > 0) {											// if there are children in this node
-		n->children = (Node*)calloc(n->childrenSize, sizeof(Node));
-		List* l = n->actionList;
-		int i = 0;
-		while (l) {														// iterating through each children
-			// initializing
-			nodeID++;
-			n->children[i].id = nodeID;
-			n->children[i].height = n->height + 1;
-			if (n->height == 0) {
-				n->children[i].originalMove = l->val;
-			}
-			else {
-				n->children[i].originalMove = n->originalMove;
-			}
-			n->children[i].value = n->value;
-			n->children[i].whiteNum = n->whiteNum;
-			n->children[i].blackNum = n->blackNum;
-			n->children[i].childrenSize = 0;
-			if (n->identity == 0) n->children[i].identity = 1; // player (min)
-			else n->children[i].identity = 0; // ai (max)
-			for (int j = 0; j < BOARD_SIZE; j++) {
-				for (int k = 0; k < BOARD_SIZE; k++) {
-					n->children[i].board[j][k].state = n->board[j][k].state;
-					n->children[i].board[j][k].directionList = listClone(n->board[j][k].directionList, n->children[i].board[j][k].directionList);
-				}
-			}
-			n->children[i].actionList = NULL;
-			n->children[i].parent = n;
-			n->children[i].children = NULL;
-
-			// get the child's board ready and the relevant values
-			if (n->children[i].identity == 1)
-				setColors(1);
-			else
-				setColors(0);
-			int flipNum = flip(n->children[i].board, l->val / BOARD_SIZE, l->val % BOARD_SIZE);
-			swapColors();
-			stateReset(n->children[i].board);
-			n->children[i].childrenSize = boardScan(n->children[i].board, 1);
-			n->children[i].actionList = tempActionList;
-			tempActionList = NULL;
-			if (n->children[i].identity == 1) {
-				n->children[i].whiteNum = n->whiteNum - flipNum;
-				n->children[i].blackNum = n->blackNum + flipNum + 1;
-				n->children[i].value = n->value + getMoveValue(l->val / BOARD_SIZE, l->val % BOARD_SIZE);
-			}
-			else {
-				n->children[i].whiteNum = n->whiteNum + flipNum + 1;
-				n->children[i].blackNum = n->blackNum - flipNum;
-				n->children[i].value = n->value - getMoveValue(l->val / BOARD_SIZE, l->val % BOARD_SIZE);
-			}
-
-			l = l->next;
-			i++;
-		}
-	}
+// set up the queue and start the worker thread, return 0 when fails
+int workerStart() {
+	memset(&aiQueue, 0, sizeof(aiQueue));
+	atomic_init(&aiQueue.cancel, 0);
+	if (mtx_init(&aiQueue.lock, mtx_plain) != thrd_success) return 0;
+	if (cnd_init(&aiQueue.ready) != thrd_success) return 0;
+	limits.cancel = &aiQueue.cancel;
+	return thrd_create(&aiThread, aiWorker, NULL) == thrd_success;
 }
 
 //@@***********************************************************************************@@
-// display the node information in the terminal
-void displayNode(Node* n) {
-	if (n) {
-		printf("========================\nDisplay Node:\n");
-		printf("id: %d\nheight: %d\noriginal move: %d\nvalue: %d\nwhiteNum: %d\nblackNum: %d\n", n->id, n->height, n->originalMove, n->value, n->whiteNum, n->blackNum);
-		if (n->identity == 0) printf("identity: ai, max\n");
-		else printf("identity: player, min\n");
-		if(n->parent)
-			printf("parent id: %d\n", n->parent->id);
-		printf("children size: %d\n", n->childrenSize);
-		displayList(n->actionList, 2);
-		printf("========================\n\n");
-	}
+// cancel the running search and wait for the worker to quit
+void workerStop() {
+	mtx_lock(&aiQueue.lock);
+	aiQueue.quit = 1;
+	atomic_store(&aiQueue.cancel, 1);
+	cnd_signal(&aiQueue.ready);
+	mtx_unlock(&aiQueue.lock);
+	thrd_join(aiThread, NULL);
 }
 
 //@@***********************************************************************************@@
-// display the board in terminal
-void displayBoard(Block b[BOARD_SIZE][BOARD_SIZE]) {
-	printf("========================================\nPrint board\n");
-	for (int i = 0; i < BOARD_SIZE; i++) {
-		for (int j = 0; j < BOARD_SIZE; j++) {
-			printf("%d ", b[i][j].state);
+// thread entry of the worker, searches the requests one at a time and queues the results
+int aiWorker(void* arg) {
+	while (1) {
+		// wait for a request
+		mtx_lock(&aiQueue.lock);
+		while (aiQueue.requestCount == 0 && !aiQueue.quit) cnd_wait(&aiQueue.ready, &aiQueue.lock);
+		if (aiQueue.quit) {
+			mtx_unlock(&aiQueue.lock);
+			return 0;
 		}
-		printf("\n");
+		AiRequest req = aiQueue.request[aiQueue.requestHead];
+		aiQueue.requestHead = (aiQueue.requestHead + 1) % QUEUE_SIZE;
+		aiQueue.requestCount--;
+		aiQueue.pondering = req.ponder;
+		atomic_store(&aiQueue.cancel, 0);						// requests of old games are already dropped
+		mtx_unlock(&aiQueue.lock);
+
+		if (req.ponder) {
+			ponder(req.black, req.white);
+			mtx_lock(&aiQueue.lock);
+			aiQueue.pondering = 0;
+			mtx_unlock(&aiQueue.lock);
+			continue;
+		}
+
+		int m = aiMove(req.black, req.white);
+
+		// hand the result to the ui, a full queue only holds results nobody waits for
+		mtx_lock(&aiQueue.lock);
+		if (req.id == aiQueue.gameId) {
+			if (aiQueue.resultCount == QUEUE_SIZE) {
+				aiQueue.resultHead = (aiQueue.resultHead + 1) % QUEUE_SIZE;
+				aiQueue.resultCount--;
+			}
+			AiResult* r = &aiQueue.result[(aiQueue.resultHead + aiQueue.resultCount) % QUEUE_SIZE];
+			r->id = req.id;
+			r->move = m;
+			aiQueue.resultCount++;
+		}
+		mtx_unlock(&aiQueue.lock);
 	}
-	printf("========================================\n\n");
 }
 
 //@@***********************************************************************************@@
-// destroy the node and all of its children
-void destroyTree(Node* n) {
-	if (n != NULL) {
-		n->parent = NULL;
-		n->actionList = deleteList(n->actionList);
-		for (int i = 0; i < n->childrenSize; i++) {
-			if(n->children) destroyTree(&n->children[i]);
-		}
-		n = NULL;
-		free(n);
+// send the current board to the worker with the ai (black) to move, the player has moved so the
+// pondering stops
+void requestAiMove() {
+	mtx_lock(&aiQueue.lock);
+	if (aiQueue.pondering) atomic_store(&aiQueue.cancel, 1);
+	aiQueue.requestCount = 0;									// only a ponder request can still wait
+
+	// the answer is ready when the reply was pondered with the full time budget
+	PonderEntry* e = NULL;
+	for (int i = 0; i < boardSize * boardSize; i++) {
+		PonderEntry* candidate = &aiQueue.ponder[i];
+		if (candidate->msec && candidate->black == blackCircles && candidate->white == whiteCircles) e = candidate;
+	}
+	if (e && (e->msec >= limits.msec || e->exact) && aiQueue.resultCount < QUEUE_SIZE) {
+		AiResult* r = &aiQueue.result[(aiQueue.resultHead + aiQueue.resultCount) % QUEUE_SIZE];
+		r->id = aiQueue.gameId;
+		r->move = e->move;
+		aiQueue.resultCount++;
+		if (searchVerbose) printf("ai move %d ponder hit msec %d%s\n", e->move, e->msec, e->exact ? " exact" : "");
 	}
+	else {
+		AiRequest* req = &aiQueue.request[aiQueue.requestHead];
+		req->id = aiQueue.gameId;
+		req->ponder = 0;
+		req->black = blackCircles;
+		req->white = whiteCircles;
+		aiQueue.requestCount++;
+		cnd_signal(&aiQueue.ready);
+	}
+	memset(aiQueue.ponder, 0, sizeof(aiQueue.ponder));
+	mtx_unlock(&aiQueue.lock);
 }
 
 //@@***********************************************************************************@@
-// delete the list and set the list pointer to null
-List* deleteList(List* h) {
-	if (h != NULL) {
-		while (h) {
-			List* temp = h;
-			h = temp->next;
-			free(temp);
-			temp = NULL;
-		}
-		h = NULL;
+// send the current board to the worker with the player (white) to move, it is searched until the
+// player moves
+void requestPonder() {
+	mtx_lock(&aiQueue.lock);
+	if (aiQueue.requestCount < QUEUE_SIZE) {
+		AiRequest* req = &aiQueue.request[(aiQueue.requestHead + aiQueue.requestCount) % QUEUE_SIZE];
+		req->id = aiQueue.gameId;
+		req->ponder = 1;
+		req->black = blackCircles;
+		req->white = whiteCircles;
+		aiQueue.requestCount++;
+		cnd_signal(&aiQueue.ready);
 	}
-	return h;
+	mtx_unlock(&aiQueue.lock);
 }
 
 //@@***********************************************************************************@@
-// display the list in terminal (mode 1: displyDirection, mode 2: displayAction)
-void displayList(List* h, int mode) {
-	switch (mode) {
-	case 1:
-		if (h) {
-			printf("Display direction: ");
-			List *l = h;
-			while (l) {
-				switch (l->val) {
-				case 0: printf("up "); break;
-				case 1: printf("rightUp "); break;
-				case 2: printf("right "); break;
-				case 3: printf("rightDown "); break;
-				case 4: printf("down "); break;
-				case 5: printf("leftDown "); break;
-				case 6: printf("left "); break;
-				case 7: printf("leftUp "); break;
-				}
-				l = l->next;
-			}
-			printf("\n");
+// search the answer to every reply of the player, first with a short time slice and then with twice
+// the time of the last round, until the player moves or every answer got the full time budget. The
+// answers go to the ponder table and everything else to the transposition table, so a reply that is
+// not ready yet is still searched faster
+void ponder(WideMask black, WideMask white) {
+	WideMask moves = kernels->moves(white, black);
+	SearchLimits ponderLimits = limits;
+	ponderLimits.ponder = 1;
+	SearchResult result;
+
+	for (int msec = PONDER_MSEC; ; msec *= 2) {
+		if (msec > limits.msec) msec = limits.msec;
+		ponderLimits.msec = msec;
+		for (WideMask m = moves; m; m &= m - 1) {
+			int x = wideLowestBit(m);
+			WideMask flips = kernels->flips(white, black, x);
+			WideMask childBlack = black & ~flips;
+			WideMask childWhite = white | flips | ((WideMask)1 << x);
+			if (kernels->search(childBlack, childWhite, 0, &ponderLimits, &result) == -1) continue;	// the ai (black) to move
+
+			mtx_lock(&aiQueue.lock);
+			if (atomic_load(&aiQueue.cancel)) {						// the player has moved
+				mtx_unlock(&aiQueue.lock);
+				return;
+			}
+			PonderEntry* e = &aiQueue.ponder[x];
+			e->black = childBlack;
+			e->white = childWhite;
+			e->move = result.move;
+			e->msec = msec;
+			e->exact = result.exact;
+			mtx_unlock(&aiQueue.lock);
 		}
-		else {
-			printf("empty list\n");
-		}
-		break;
-	case 2:
-		if (h) {
-			printf("Display action positions (0 - 63): ");
-			List *l = h;
-			while (l) {
-				printf("%d ", l->val);
-				l = l->next;
-			}
-			printf("\n");
-		}
-		else {
-			printf("empty list\n");
-		}
-		break;
+		if (msec >= limits.msec) return;
 	}
 }
 
 //@@***********************************************************************************@@
-// add a new list at front of a list
-List* addToListFront(List* h, int d) {
-	List* newList = (List*)malloc(sizeof(List));
-	newList->val = d;
-	newList->next = NULL;
-	if (!h) h = newList;
-	else {
-		newList->next = h;
-		h = newList;
+// take the next result of the current game without waiting, return 0 if the worker is not done
+int pollAiMove(int* m) {
+	int found = 0;
+	mtx_lock(&aiQueue.lock);
+	while (aiQueue.resultCount > 0 && !found) {
+		AiResult* r = &aiQueue.result[aiQueue.resultHead];
+		aiQueue.resultHead = (aiQueue.resultHead + 1) % QUEUE_SIZE;
+		aiQueue.resultCount--;
+		if (r->id == aiQueue.gameId) {							// results of old games are dropped
+			*m = r->move;
+			found = 1;
+		}
 	}
-	return h;
+	mtx_unlock(&aiQueue.lock);
+	return found;
 }
 
 //@@***********************************************************************************@@
-// clone the list to another list
-List* listClone(List* sourceList, List* targetList) {
-	if (targetList) targetList = deleteList(targetList);
-	List* temp = sourceList;
-	while (temp) {
-		targetList = addToListFront(targetList, temp->val);
-		temp = temp->next;
-	}
-	return targetList;
-}
\ No newline at end of file
+// start a new game number, drop its waiting requests and results and stop the running search
+void cancelAiMove() {
+	mtx_lock(&aiQueue.lock);
+	aiQueue.gameId++;
+	aiQueue.requestCount = 0;
+	aiQueue.resultCount = 0;
+	memset(aiQueue.ponder, 0, sizeof(aiQueue.ponder));
+	atomic_store(&aiQueue.cancel, 1);
+	mtx_unlock(&aiQueue.lock);
+}
@@ -0,0 +1,529 @@
+/*
+*** FILE NAME   : othello_match.c
+*** PURPOSE		: Plays two engine programs against each other to tell whether a change makes the ai stronger
+*** DESCRIPTION : Each engine is a command that speaks the othello_cli format: it reads a position per
+				  line and answers with a line "n move <move> ... nodes <n> msec <ms>", for example
+				  "./othello_cli -time 100". Comparing two builds of othello_cli (a change of
+				  getMoveValue, ALPHABETAHEIGHT or the search) or two settings of the same build works
+				  the same way. Every opening is played twice with the colours swapped, and several
+				  games run at once, each with its own two engine processes (one game per core by
+				  default). The openings are the distinct positions (rotations and mirrors removed)
+				  after OPENING_PLIES random plies whose OPENING_DEPTH search score is within
+				  OPENING_MARGIN circles, or the ones of a file. After every game the sequential
+				  probability ratio test (SPRT) of the results is checked and the match stops when it
+				  accepts one of its hypotheses. At the end the wins, draws and losses of engine 1,
+				  the Elo difference with its 95% error bars, the SPRT verdict and the time and nodes
+				  per move of both engines are printed.
+				  Options: -games <n> (most games), -concurrency <n> (games at once), -openings <file>
+				  (game records like f5d6c3 or positions "board side" per line), -plies <n>, -seed <n>,
+				  -elo0 <elo> -elo1 <elo> -alpha <a> -beta <b> (the SPRT tests elo0 against elo1)
+				  Usage: othello_match [options] "<engine 1 command>" "<engine 2 command>"
+*/
+
+#include <stdio.h>						// standard C libraries
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <threads.h>
+#include <signal.h>						// POSIX libraries for the engine processes
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/wait.h>
+#include "othello_engine.h"				// rules of the game
+
+
+//@@***********************************************************************************@@
+// Constants
+#define MATCH_GAMES 1000				// default most games of a match
+#define OPENING_PLIES 6					// default plies of a generated opening
+#define OPENING_DEPTH 6					// search depth that scores the generated openings
+#define OPENING_MARGIN 4				// largest score in circles of a generated opening
+#define SPRT_ELO0 0						// default Elo difference of the null hypothesis
+#define SPRT_ELO1 10					// default Elo difference of the alternative hypothesis
+#define SPRT_ALPHA 0.05					// default false positive rate
+#define SPRT_BETA 0.05					// default false negative rate
+#define LINE_SIZE 256					// longest line of an engine or an openings file
+
+
+//@@***********************************************************************************@@
+// Structs
+
+// A position that a pair of games starts from
+typedef struct opening {
+	uint64_t black;						// black circles
+	uint64_t white;						// white circles
+	int identity;						// side to move, 0: black, 1: white
+} Opening;
+
+// A running engine program and what it used
+typedef struct engineProcess {
+	pid_t pid;							// the process, 0 if it is not running
+	FILE* in;							// the standard input of the engine
+	FILE* out;							// the standard output of the engine
+	long long moves;					// moves it played
+	long long nodes;					// nodes it reported
+	long long msec;						// time it reported in ms
+} EngineProcess;
+
+// The state of a match that the game threads share, changed under the lock
+typedef struct match {
+	Opening* openings;					// the openings in the order they are played
+	int openingNum;
+	int games;							// most games
+	mtx_t lock;
+	int next;							// next game to start
+	int played;							// finished games
+	int wins;							// results of engine 1
+	int draws;
+	int losses;
+	double elo0, elo1;					// the hypotheses of the SPRT
+	double alpha, beta;					// the error rates of the SPRT
+	int verdict;						// 1: elo1 accepted, -1: elo0 accepted, 0: not decided yet
+} Match;
+
+// One game thread with its own pair of engines
+typedef struct matchSlot {
+	Match* match;
+	EngineProcess engine[2];			// [0]: engine 1, [1]: engine 2
+} MatchSlot;
+
+
+//@@***********************************************************************************@@
+// Function
+
+int startEngine(EngineProcess* e, char* command);			// run an engine command with pipes to its input and output, return 0 when fails
+void stopEngine(EngineProcess* e);							// close the input of an engine and wait for it to finish
+int askEngine(EngineProcess* e, Position* p);				// send a position to an engine and read its move, return -1 when it fails
+int gameThread(void* arg);									// thread entry, play games until the match is over
+int playGame(MatchSlot* slot, Opening* o, int black, int game);	// play a game, engine black (0 or 1) is black, return the result of engine 1
+int generateOpenings(int plies, int games, int margin, Opening** list);	// list the balanced openings in random order, return the number
+void addOpenings(Position* p, int plies, Opening** list, int* n, int* size);	// add the positions plies moves away
+int compareOpenings(const void* a, const void* b);			// order of the openings for sorting
+int readOpenings(char* fileName, Opening** list);			// read the openings of a file, return the number
+double matchScore(Match* m, double* variance);				// score of engine 1 per game and the variance of a game's score
+double sprtRatio(Match* m);									// log-likelihood ratio of elo1 against elo0
+double eloOf(double score);									// Elo difference of an expected score
+void report(Match* m, EngineProcess total[2]);				// print the results of the match
+
+
+//@@***********************************************************************************@@
+int main(int argc, char **argv)
+{
+	// optional arguments: -games <n>, -concurrency <n>, -openings <file>, -plies <n>, -seed <n>, -elo0, -elo1, -alpha, -beta
+	Match m;
+	char* commands[2];
+	int commandNum = 0;
+	int concurrency = (int)sysconf(_SC_NPROCESSORS_ONLN);
+	char* openingFile = NULL;
+	int plies = OPENING_PLIES;
+	int seed = 1;
+	memset(&m, 0, sizeof(m));
+	m.games = MATCH_GAMES;
+	m.elo0 = SPRT_ELO0;
+	m.elo1 = SPRT_ELO1;
+	m.alpha = SPRT_ALPHA;
+	m.beta = SPRT_BETA;
+	int size = 8;
+	for (int i = 1; i < argc; i++) {
+		if (argv[i][0] != '-') {
+			if (commandNum < 2) commands[commandNum++] = argv[i];
+		}
+		else if (i + 1 >= argc) break;
+		else if (strcmp(argv[i], "-games") == 0) m.games = atoi(argv[++i]);
+		else if (strcmp(argv[i], "-concurrency") == 0) concurrency = atoi(argv[++i]);
+		else if (strcmp(argv[i], "-openings") == 0) openingFile = argv[++i];
+		else if (strcmp(argv[i], "-plies") == 0) plies = atoi(argv[++i]);
+		else if (strcmp(argv[i], "-seed") == 0) seed = atoi(argv[++i]);
+		else if (strcmp(argv[i], "-elo0") == 0) m.elo0 = atof(argv[++i]);
+		else if (strcmp(argv[i], "-elo1") == 0) m.elo1 = atof(argv[++i]);
+		else if (strcmp(argv[i], "-alpha") == 0) m.alpha = atof(argv[++i]);
+		else if (strcmp(argv[i], "-beta") == 0) m.beta = atof(argv[++i]);
+		else if (strcmp(argv[i], "-size") == 0) size = atoi(argv[++i]);
+	}
+	if (size != 8) {												// the openings and the engines speak 8x8 positions
+		fprintf(stderr, "othello_match works on the 8x8 board only, -size %d is not supported.\n", size);
+		return 1;
+	}
+	if (commandNum < 2) {
+		fprintf(stderr, "Usage: othello_match [options] \"<engine 1 command>\" \"<engine 2 command>\"\n");
+		return 1;
+	}
+	if (concurrency < 1) concurrency = 1;
+	if (concurrency > (m.games + 1) / 2 * 2) concurrency = (m.games + 1) / 2 * 2;
+	if (!engineInit(HASH_MB)) {
+		fprintf(stderr, "Cannot allocate the transposition table.\n");
+		return 1;
+	}
+	patternLoad(PATTERN_FILE);									// the openings are scored with the default weights when they exist
+	int margin = OPENING_MARGIN * evaluationUnit();
+
+	// the openings
+	srand(seed);
+	m.openingNum = openingFile ? readOpenings(openingFile, &m.openings) : generateOpenings(plies, (m.games + 1) / 2, margin, &m.openings);
+	if (m.openingNum == 0) {
+		fprintf(stderr, "No openings.\n");
+		return 1;
+	}
+	printf("openings %d games %d concurrency %d\n", m.openingNum, m.games, concurrency);
+
+	// all the engines are started before the threads, so no process inherits the pipes of another
+	signal(SIGPIPE, SIG_IGN);
+	MatchSlot* slots = (MatchSlot*)calloc(concurrency, sizeof(MatchSlot));
+	thrd_t* ids = (thrd_t*)malloc(concurrency * sizeof(thrd_t));
+	if (!slots || !ids || mtx_init(&m.lock, mtx_plain) != thrd_success) {
+		fprintf(stderr, "Out of memory.\n");
+		return 1;
+	}
+	for (int t = 0; t < concurrency; t++) {
+		slots[t].match = &m;
+		for (int k = 0; k < 2; k++) {
+			if (!startEngine(&slots[t].engine[k], commands[k])) {
+				fprintf(stderr, "Cannot start engine %d: %s\n", k + 1, commands[k]);
+				return 1;
+			}
+		}
+	}
+	int started = 0;
+	for (; started < concurrency; started++) {
+		if (thrd_create(&ids[started], gameThread, &slots[started]) != thrd_success) break;
+	}
+	for (int t = 0; t < started; t++) thrd_join(ids[t], NULL);
+
+	EngineProcess total[2];
+	memset(total, 0, sizeof(total));
+	for (int t = 0; t < concurrency; t++) {
+		for (int k = 0; k < 2; k++) {
+			stopEngine(&slots[t].engine[k]);
+			total[k].moves += slots[t].engine[k].moves;
+			total[k].nodes += slots[t].engine[k].nodes;
+			total[k].msec += slots[t].engine[k].msec;
+		}
+	}
+	report(&m, total);
+	return 0;
+}
+
+//@@***********************************************************************************@@
+// run an engine command through the shell with pipes to its standard input and output, return 0 when fails
+int startEngine(EngineProcess* e, char* command) {
+	int toEngine[2], fromEngine[2];
+
+	memset(e, 0, sizeof(EngineProcess));
+	if (pipe(toEngine) != 0) return 0;
+	if (pipe(fromEngine) != 0) {
+		close(toEngine[0]);
+		close(toEngine[1]);
+		return 0;
+	}
+	pid_t pid = fork();
+	if (pid < 0) return 0;
+	if (pid == 0) {
+		dup2(toEngine[0], 0);
+		dup2(fromEngine[1], 1);
+		close(toEngine[0]);
+		close(toEngine[1]);
+		close(fromEngine[0]);
+		close(fromEngine[1]);
+		execl("/bin/sh", "sh", "-c", command, (char*)NULL);
+		_exit(127);
+	}
+
+	close(toEngine[0]);
+	close(fromEngine[1]);
+	fcntl(toEngine[1], F_SETFD, FD_CLOEXEC);				// the engines started later do not keep this one's pipes open
+	fcntl(fromEngine[0], F_SETFD, FD_CLOEXEC);
+	e->pid = pid;
+	e->in = fdopen(toEngine[1], "w");
+	e->out = fdopen(fromEngine[0], "r");
+	return e->in && e->out;
+}
+
+//@@***********************************************************************************@@
+// close the input of an engine, it finishes when it reads the end, and wait for it
+void stopEngine(EngineProcess* e) {
+	if (!e->pid) return;
+	fclose(e->in);
+	fclose(e->out);
+	waitpid(e->pid, NULL, 0);
+	e->pid = 0;
+}
+
+//@@***********************************************************************************@@
+// send a position to an engine and read its move and the nodes and time it reports, return -1 when
+// the engine does not answer with a move
+int askEngine(EngineProcess* e, Position* p) {
+	char line[LINE_SIZE];
+	uint64_t black = p->identity == 0 ? p->board.player : p->board.opponent;
+	uint64_t white = p->identity == 0 ? p->board.opponent : p->board.player;
+
+	for (int x = 0; x < BOARD_SIZE * BOARD_SIZE; x++) line[x] = ((black >> x) & 1) ? 'X' : (((white >> x) & 1) ? 'O' : '-');
+	line[BOARD_SIZE * BOARD_SIZE] = '\0';
+	if (fprintf(e->in, "%s %c\n", line, p->identity ? 'O' : 'X') < 0 || fflush(e->in) != 0) return -1;
+	if (!fgets(line, sizeof(line), e->out)) return -1;
+
+	char* s = strstr(line, "move ");
+	char* nodes = strstr(line, "nodes ");
+	char* msec = strstr(line, "msec ");
+	if (!s) return -1;
+	e->moves++;
+	if (nodes) e->nodes += atoll(nodes + 6);
+	if (msec) e->msec += atoll(msec + 5);
+	return readMove(s + 5);
+}
+
+//@@***********************************************************************************@@
+// thread entry, take the next game of the match until all are played or the SPRT has decided
+int gameThread(void* arg) {
+	MatchSlot* slot = (MatchSlot*)arg;
+	Match* m = slot->match;
+
+	while (1) {
+		mtx_lock(&m->lock);
+		int game = m->next;
+		if (game >= m->games || m->verdict != 0) {
+			mtx_unlock(&m->lock);
+			break;
+		}
+		m->next++;
+		mtx_unlock(&m->lock);
+
+		// both games of an opening, engine 1 is black in the even game
+		int result = playGame(slot, &m->openings[game / 2 % m->openingNum], game % 2, game);
+
+		mtx_lock(&m->lock);
+		if (result > 0) m->wins++;
+		else if (result < 0) m->losses++;
+		else m->draws++;
+		m->played++;
+		double ratio = sprtRatio(m);
+		if (m->verdict == 0 && ratio >= log((1 - m->beta) / m->alpha)) m->verdict = 1;
+		if (m->verdict == 0 && ratio <= log(m->beta / (1 - m->alpha))) m->verdict = -1;
+		printf("game %d opening %d engine 1 %s %+d: +%d =%d -%d llr %.2f\n", game + 1, game / 2 % m->openingNum + 1,
+			game % 2 ? "white" : "black", result, m->wins, m->draws, m->losses, ratio);
+		fflush(stdout);
+		mtx_unlock(&m->lock);
+	}
+	return 0;
+}
+
+//@@***********************************************************************************@@
+// play a game from an opening, engine black (0: engine 1, 1: engine 2) plays black. An engine that does
+// not answer with a legal move loses the game by the whole board. Return the result of engine 1
+int playGame(MatchSlot* slot, Opening* o, int black, int game) {
+	Position p;
+	Undo u;
+
+	setPosition(&p, o->black, o->white, o->identity);
+	while (1) {
+		uint64_t moves = getMoves(p.board.player, p.board.opponent);
+		if (!moves) {
+			if (!getMoves(p.board.opponent, p.board.player)) break;		// game over
+			makePass(&p);
+			continue;
+		}
+		int k = p.identity == 0 ? black : 1 - black;					// the engine of the side to move
+		int x = askEngine(&slot->engine[k], &p);
+		if (x < 0 || !((moves >> x) & 1)) {
+			fprintf(stderr, "Engine %d did not play a legal move in game %d.\n", k + 1, game + 1);
+			return k == 0 ? -BOARD_SIZE * BOARD_SIZE : BOARD_SIZE * BOARD_SIZE;
+		}
+		makeMove(&p, x, &u);
+	}
+
+	int score = finalScore(p.board.player, p.board.opponent);
+	if (p.identity == 1) score = -score;								// from black
+	return black == 0 ? score : -score;
+}
+
+//@@***********************************************************************************@@
+// list the distinct positions plies moves away from the start (a rotation or mirror of one counts as
+// the same) in random order, and keep the ones whose search score is within the margin until there
+// is one for every pair of games. Return the number of openings
+int generateOpenings(int plies, int games, int margin, Opening** list) {
+	Position p;
+	int n = 0, size = 0;
+
+	*list = NULL;
+	startPosition(&p, 0);
+	addOpenings(&p, plies, list, &n, &size);
+	if (n == 0) return 0;
+	qsort(*list, n, sizeof(Opening), compareOpenings);
+	int unique = 1;
+	for (int i = 1; i < n; i++) {
+		if (compareOpenings(&(*list)[i], &(*list)[unique - 1]) != 0) (*list)[unique++] = (*list)[i];
+	}
+	for (int i = unique - 1; i > 0; i--) {								// shuffle
+		int j = rand() % (i + 1);
+		Opening temp = (*list)[i];
+		(*list)[i] = (*list)[j];
+		(*list)[j] = temp;
+	}
+
+	SearchLimits limits;
+	defaultLimits(&limits);
+	limits.maxDepth = OPENING_DEPTH;
+	int kept = 0;
+	for (int i = 0; i < unique && kept < games; i++) {
+		SearchResult result;
+		setPosition(&p, (*list)[i].black, (*list)[i].white, (*list)[i].identity);
+		searchPosition(&p, &limits, &result);
+		if (abs(result.score) <= margin) (*list)[kept++] = (*list)[i];
+	}
+	return kept;
+}
+
+//@@***********************************************************************************@@
+// add the positions plies moves away from p, each one in the rotation or mirror that comes first
+void addOpenings(Position* p, int plies, Opening** list, int* n, int* size) {
+	uint64_t moves = getMoves(p->board.player, p->board.opponent);
+	Undo u;
+
+	if (plies > 0) {
+		for (; moves; moves &= moves - 1) {
+			makeMove(p, lowestBit(moves), &u);
+			addOpenings(p, plies - 1, list, n, size);
+			undoMove(p, &u);
+		}
+		return;
+	}
+	if (!moves) return;													// a finished game or a pass is no opening
+
+	if (*n == *size) {
+		*size = *size ? 2 * *size : 1024;
+		*list = (Opening*)realloc(*list, *size * sizeof(Opening));
+	}
+	uint64_t black = p->identity == 0 ? p->board.player : p->board.opponent;
+	uint64_t white = p->identity == 0 ? p->board.opponent : p->board.player;
+	Opening best = { black, white, p->identity };
+	for (int s = 1; s < 8; s++) {
+		Opening o = { symmetryBits(black, s), symmetryBits(white, s), p->identity };
+		if (compareOpenings(&o, &best) < 0) best = o;
+	}
+	(*list)[(*n)++] = best;
+}
+
+//@@***********************************************************************************@@
+// order of the openings for sorting: black circles, white circles, then the side to move
+int compareOpenings(const void* a, const void* b) {
+	const Opening* x = (const Opening*)a;
+	const Opening* y = (const Opening*)b;
+	if (x->black != y->black) return x->black < y->black ? -1 : 1;
+	if (x->white != y->white) return x->white < y->white ? -1 : 1;
+	return x->identity - y->identity;
+}
+
+//@@***********************************************************************************@@
+// read the openings of a file: a game record (moves like f5d6c3, passes left out) or a position
+// (64 board characters and the side to move) per line, other lines are skipped with a warning. Return
+// the number of openings
+int readOpenings(char* fileName, Opening** list) {
+	FILE* in = fopen(fileName, "r");
+	char line[LINE_SIZE];
+	int n = 0, size = 0;
+
+	*list = NULL;
+	if (!in) {
+		fprintf(stderr, "Cannot open %s.\n", fileName);
+		return 0;
+	}
+	while (fgets(line, sizeof(line), in)) {
+		char* s = line;
+		while (*s == ' ' || *s == '\t') s++;
+		if (*s == '#' || *s == '\n' || *s == '\r' || *s == '\0') continue;
+
+		Position p;
+		Undo u;
+		int x;
+		if (!readPosition(s, &p)) {
+			// a game record
+			int legal = 1;
+			int plies = 0;
+			startPosition(&p, 0);
+			for (; legal && (x = readMove(s)) >= 0; s += 2, plies++) {
+				uint64_t moves = getMoves(p.board.player, p.board.opponent);
+				if (!moves) {
+					makePass(&p);
+					moves = getMoves(p.board.player, p.board.opponent);
+				}
+				legal = (moves >> x) & 1;
+				if (legal) makeMove(&p, x, &u);
+			}
+			if (!legal) {
+				fprintf(stderr, "Skipped an opening with an illegal move: %s", line);
+				continue;
+			}
+			if (plies == 0) {
+				fprintf(stderr, "Skipped a line that is neither a position nor a game record: %s", line);
+				continue;
+			}
+		}
+
+		if (n == size) {
+			size = size ? 2 * size : 64;
+			*list = (Opening*)realloc(*list, size * sizeof(Opening));
+		}
+		(*list)[n].black = p.identity == 0 ? p.board.player : p.board.opponent;
+		(*list)[n].white = p.identity == 0 ? p.board.opponent : p.board.player;
+		(*list)[n].identity = p.identity;
+		n++;
+	}
+	fclose(in);
+	return n;
+}
+
+//@@***********************************************************************************@@
+// score of engine 1 per game (win 1, draw 1/2, loss 0) and the variance of the score of a game. Every
+// result is counted half a game more in the variance, so a match without losses does not have zero variance
+double matchScore(Match* m, double* variance) {
+	double n = m->wins + m->draws + m->losses;
+	double score = n > 0 ? (m->wins + 0.5 * m->draws) / n : 0.5;
+	double w = m->wins + 0.5, d = m->draws + 0.5, l = m->losses + 0.5;
+	double mean = (w + 0.5 * d) / (n + 1.5);
+	*variance = (w * (1 - mean) * (1 - mean) + d * (0.5 - mean) * (0.5 - mean) + l * mean * mean) / (n + 1.5);
+	return score;
+}
+
+//@@***********************************************************************************@@
+// log-likelihood ratio of the results under elo1 against elo0, with the score of a game taken as normal
+double sprtRatio(Match* m) {
+	double variance;
+	double score = matchScore(m, &variance);
+	double n = m->wins + m->draws + m->losses;
+	double s0 = 1 / (1 + pow(10, -m->elo0 / 400));
+	double s1 = 1 / (1 + pow(10, -m->elo1 / 400));
+	return n * (s1 - s0) * (2 * score - s0 - s1) / (2 * variance);
+}
+
+//@@***********************************************************************************@@
+// Elo difference of an expected score, limited to +-1000 for a score of 1 or 0
+double eloOf(double score) {
+	if (score <= 0) return -1000;
+	if (score >= 1) return 1000;
+	double elo = -400 * log10(1 / score - 1);
+	return elo < -1000 ? -1000 : (elo > 1000 ? 1000 : elo);
+}
+
+//@@***********************************************************************************@@
+// print the results of engine 1, the Elo difference with its 95% error bars (only the bound that exists
+// when the interval reaches a score of 0 or 1), the SPRT verdict and the time and nodes per move of both engines
+void report(Match* m, EngineProcess total[2]) {
+	int n = m->wins + m->draws + m->losses;
+	if (n == 0) return;
+	double variance;
+	double score = matchScore(m, &variance);
+	double margin = 1.96 * sqrt(variance / n);
+
+	printf("games %d engine 1 wins %d draws %d losses %d score %.1f%%\n", n, m->wins, m->draws, m->losses, 100 * score);
+	if (score - margin > 0 && score + margin < 1) printf("elo %+.1f +/- %.1f (95%%)\n", eloOf(score), (eloOf(score + margin) - eloOf(score - margin)) / 2);
+	else if (score - margin > 0) printf("elo > %+.1f (95%%)\n", eloOf(score - margin));		// no loss yet, only the lower bound is known
+	else if (score + margin < 1) printf("elo < %+.1f (95%%)\n", eloOf(score + margin));		// no win yet
+	else printf("elo unknown, too few games\n");
+	printf("sprt elo0 %.1f elo1 %.1f alpha %.2f beta %.2f llr %.2f (%.2f, %.2f) %s\n", m->elo0, m->elo1, m->alpha, m->beta,
+		sprtRatio(m), log(m->beta / (1 - m->alpha)), log((1 - m->beta) / m->alpha),
+		m->verdict > 0 ? "elo1 accepted" : (m->verdict < 0 ? "elo0 accepted" : "no verdict"));
+	for (int k = 0; k < 2; k++) {
+		long long moves = total[k].moves > 0 ? total[k].moves : 1;
+		printf("engine %d moves %lld msec/move %.1f nodes/move %lld nps %lld\n", k + 1, total[k].moves,
+			(double)total[k].msec / moves, total[k].nodes / moves, total[k].msec > 0 ? total[k].nodes * 1000 / total[k].msec : 0);
+	}
+}
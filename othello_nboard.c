@@ -0,0 +1,426 @@
+/*
+*** FILE NAME   : othello_nboard.c
+*** PURPOSE		: Text protocol front-end of the Othello ai for GUIs and match servers (NBoard protocol)
+*** DESCRIPTION : The commands are read line by line from the standard input and the answers are written
+				  to the standard output. The searches run on a worker thread, so the commands that come
+				  while the ai thinks are still read: stop and ping end the running search at once.
+				  NBoard commands: nboard <version>, set depth <n>, set game <GGF game>, set contempt <n>
+				  (ignored), move <move>[/<eval>[/<time>]], go, hint <n>, ping <n>, learn, quit.
+				  Extensions: set time <ms>, set threads <n>, set selectivity <sigmas>, set ponder on|off,
+				  set position <board> <side> (the othello_cli format), go [depth <n>] [time <ms>], stop.
+				  go answers "=== <move>/<eval>/<seconds>", hint streams "search <pv> <eval> 0 <depth>"
+				  for the best n moves after every iteration, evals are in circles for the side to move.
+				  After every move or new game the worker ponders the position until the next command.
+				  Options: -time <ms>, -depth <max depth>, -threads <n>, -hash <MB>, -endgame <empties>,
+				  -eval <file>, -book <file>, -nobook, -cache <file>, -probcut <file>, -selectivity <sigmas>,
+				  -noponder
+*/
+
+#include <stdio.h>						// standard C libraries
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <ctype.h>
+#include <threads.h>
+#include "othello_engine.h"				// rules and search of the ai
+
+
+//@@***********************************************************************************@@
+// Constants
+#define LINE_SIZE 8192					// longest command, a set game command holds a whole game
+#define ENGINE_NAME "C-Othello"			// name sent to the GUI
+#define PONDER_MSEC (1 << 30)			// time budget of pondering, it only ends when a command comes
+#define JOB_NONE 0						// the worker is idle
+#define JOB_GO 1						// search the best move and answer with ===
+#define JOB_HINT 2						// stream the scores of the best moves
+#define JOB_PONDER 3					// search the position until cancelled, print nothing
+
+
+//@@***********************************************************************************@@
+// Structs
+
+// Search handed from the reader to the worker thread, every field except cancel is guarded by lock
+typedef struct engineJob {
+	mtx_t lock;
+	cnd_t ready;						// signaled when a job is handed over or the worker has to quit
+	cnd_t idle;							// signaled when the worker has finished a job
+	int type;							// JOB_NONE or the job waiting or running
+	int quit;							// set when the worker has to quit
+	Position pos;						// the position to search
+	SearchLimits limits;				// the limits of the search
+	int multiPv;						// moves scored by a hint
+	atomic_int cancel;					// stops the running search, read by the search threads
+} EngineJob;
+
+//@@***********************************************************************************@@
+// Global variables
+
+Position game;							// the current position of the game
+SearchLimits limits;					// limits of go and hint
+int ponderEnabled = 1;					// search the current position while waiting for a command
+EngineJob job;							// the job of the worker
+thrd_t worker;							// the search thread
+mtx_t outputLock;						// one thread writes an answer at a time
+
+//@@***********************************************************************************@@
+// Function
+
+int handleCommand(char* line);								// carry out one command, return 0 on quit
+int workerThread(void* arg);								// thread entry, run the jobs until quit
+void startJob(int type, Position* p, SearchLimits* l, int multiPv);	// hand a job to the idle worker
+void stopJob(int all);										// cancel the ponder search (or any search when all is set) and wait until idle
+void runGo(Position* p, SearchLimits* l);					// search the best move and answer with ===
+void runHint(Position* p, SearchLimits* l, int multiPv);	// stream the scores of the best moves
+void reportHint(Analysis* a, void* data);					// write the search lines of one iteration
+void reply(const char* format, ...);						// write one answer line and flush it
+int parseGame(char* s, Position* p);						// read a GGF game and play its moves, return 0 if it is not valid
+int playMove(Position* p, int move);						// play a move or a pass, return 0 if it is not legal
+void nboardMove(int move, char* name);						// write the move like F5, PA for a pass
+double circles(int score, int exact);						// score in circles
+
+
+//@@***********************************************************************************@@
+int main(int argc, char **argv)
+{
+	// optional arguments: -time <ms>, -depth <max depth>, -threads <n>, -hash <MB>, -endgame <empties>, -eval <file>,
+	// -book <file>, -nobook, -cache <file>, -probcut <file>, -selectivity <sigmas>, -noponder
+	int hashMB = HASH_MB;
+	char* evalFile = NULL;
+	char* probcutFile = NULL;
+	char* bookFile = NULL;
+	int useBook = 1;
+	char* cacheFile = NULL;
+	defaultLimits(&limits);
+	int size = 8;
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "-nobook") == 0) useBook = 0;
+		else if (strcmp(argv[i], "-noponder") == 0) ponderEnabled = 0;
+		else if (i + 1 >= argc) break;
+		else if (strcmp(argv[i], "-hash") == 0) hashMB = atoi(argv[++i]);
+		else if (strcmp(argv[i], "-time") == 0) limits.msec = atoi(argv[++i]);
+		else if (strcmp(argv[i], "-depth") == 0) limits.maxDepth = atoi(argv[++i]);
+		else if (strcmp(argv[i], "-threads") == 0) limits.threads = atoi(argv[++i]);
+		else if (strcmp(argv[i], "-endgame") == 0) limits.endgameEmpties = atoi(argv[++i]);
+		else if (strcmp(argv[i], "-eval") == 0) evalFile = argv[++i];
+		else if (strcmp(argv[i], "-probcut") == 0) probcutFile = argv[++i];
+		else if (strcmp(argv[i], "-selectivity") == 0) limits.probcut = atof(argv[++i]);
+		else if (strcmp(argv[i], "-book") == 0) bookFile = argv[++i];
+		else if (strcmp(argv[i], "-cache") == 0) cacheFile = argv[++i];
+		else if (strcmp(argv[i], "-size") == 0) size = atoi(argv[++i]);
+	}
+	if (size != 8) {												// the NBoard protocol plays the 8x8 board
+		fprintf(stderr, "othello_nboard works on the 8x8 board only, -size %d is not supported.\n", size);
+		return 1;
+	}
+	if (!engineInit(hashMB)) {
+		fprintf(stderr, "Cannot allocate %d MB for the transposition table.\n", hashMB);
+		return 1;
+	}
+	if (!evalFile) patternLoad(PATTERN_FILE);					// the default weights are optional
+	else if (!patternLoad(evalFile)) {
+		fprintf(stderr, "Cannot load the weights from %s.\n", evalFile);
+		return 1;
+	}
+	if (!probcutFile) probcutLoad(PROBCUT_FILE);				// the default parameters are optional
+	else if (!probcutLoad(probcutFile)) {
+		fprintf(stderr, "Cannot load the multi-probcut parameters from %s, or they were fitted with another evaluation.\n", probcutFile);
+		return 1;
+	}
+	if (useBook && !bookFile) bookOpen(BOOK_FILE);				// the default book is optional
+	else if (useBook && !bookOpen(bookFile)) {
+		fprintf(stderr, "Cannot open the book %s.\n", bookFile);
+		return 1;
+	}
+	if (cacheFile && !cacheOpen(cacheFile)) {
+		fprintf(stderr, "Cannot open the cache %s, or it was made with another evaluation.\n", cacheFile);
+		return 1;
+	}
+
+	// start the worker
+	memset(&job, 0, sizeof(job));
+	atomic_init(&job.cancel, 0);
+	if (mtx_init(&job.lock, mtx_plain) != thrd_success || cnd_init(&job.ready) != thrd_success ||
+		cnd_init(&job.idle) != thrd_success || mtx_init(&outputLock, mtx_plain) != thrd_success) return 1;
+	limits.cancel = &job.cancel;
+	if (thrd_create(&worker, workerThread, NULL) != thrd_success) return 1;
+	startPosition(&game, 0);
+
+	// read the commands until quit or the end of the input
+	char line[LINE_SIZE];
+	while (fgets(line, sizeof(line), stdin) && handleCommand(line));
+
+	mtx_lock(&job.lock);
+	job.quit = 1;
+	atomic_store(&job.cancel, 1);
+	cnd_signal(&job.ready);
+	mtx_unlock(&job.lock);
+	thrd_join(worker, NULL);
+	cacheClose();
+	return 0;
+}
+
+//@@***********************************************************************************@@
+// carry out one command, return 0 on quit. The commands that change the game or the settings wait
+// for the running go or hint, only stop, ping and quit cut it short
+int handleCommand(char* line) {
+	char word[32] = "";
+	char key[32] = "";
+	int n = 0;
+	line[strcspn(line, "\r\n")] = '\0';
+	sscanf(line, "%31s %n", word, &n);
+	char* args = line + n;
+
+	if (strcmp(word, "quit") == 0) {
+		stopJob(1);
+		return 0;
+	}
+	else if (strcmp(word, "stop") == 0) stopJob(1);
+	else if (strcmp(word, "ping") == 0) {
+		stopJob(1);
+		reply("pong %s\n", args);
+	}
+	else if (strcmp(word, "nboard") == 0) reply("set myname %s\n", ENGINE_NAME);
+	else if (strcmp(word, "learn") == 0) reply("learned\n");
+	else if (strcmp(word, "set") == 0) {
+		sscanf(args, "%31s %n", key, &n);
+		char* value = args + n;
+		stopJob(0);
+		if (strcmp(key, "depth") == 0) limits.maxDepth = atoi(value) > 0 ? atoi(value) : ALPHABETAHEIGHT;
+		else if (strcmp(key, "time") == 0) limits.msec = atoi(value) > 0 ? atoi(value) : SEARCH_MSEC;
+		else if (strcmp(key, "threads") == 0) limits.threads = atoi(value) > 0 ? atoi(value) : 1;
+		else if (strcmp(key, "selectivity") == 0) limits.probcut = atof(value);
+		else if (strcmp(key, "ponder") == 0) ponderEnabled = strcmp(value, "off") != 0;
+		else if (strcmp(key, "contempt") == 0);						// draws are scored as 0
+		else if (strcmp(key, "game") == 0 || strcmp(key, "position") == 0) {
+			Position p;
+			if (strcmp(key, "game") == 0 ? parseGame(value, &p) : readPosition(value, &p) != NULL) {
+				game = p;
+				if (ponderEnabled) startJob(JOB_PONDER, &game, &limits, 0);
+			}
+			else fprintf(stderr, "Cannot read the %s: %s\n", key, value);
+		}
+		else fprintf(stderr, "Unknown setting: %s\n", key);
+	}
+	else if (strcmp(word, "move") == 0) {
+		stopJob(0);
+		Position p = game;
+		if (playMove(&p, readMove(args))) {
+			game = p;
+			if (ponderEnabled) startJob(JOB_PONDER, &game, &limits, 0);
+		}
+		else fprintf(stderr, "Illegal move: %s\n", args);
+	}
+	else if (strcmp(word, "go") == 0) {
+		SearchLimits l = limits;
+		int value;
+		while (sscanf(args, "%31s %d %n", key, &value, &n) == 2) {
+			if (strcmp(key, "depth") == 0) l.maxDepth = value;
+			else if (strcmp(key, "time") == 0) l.msec = value;
+			args += n;
+		}
+		stopJob(0);
+		startJob(JOB_GO, &game, &l, 0);
+	}
+	else if (strcmp(word, "hint") == 0) {
+		stopJob(0);
+		startJob(JOB_HINT, &game, &limits, atoi(args) > 0 ? atoi(args) : 1);
+	}
+	else if (word[0] != '\0' && strcmp(word, "analyze") != 0) fprintf(stderr, "Unknown command: %s\n", word);
+	return 1;
+}
+
+//@@***********************************************************************************@@
+// thread entry of the worker, runs the jobs one at a time until quit
+int workerThread(void* arg) {
+	(void)arg;
+	while (1) {
+		// wait for a job
+		mtx_lock(&job.lock);
+		while (job.type == JOB_NONE && !job.quit) cnd_wait(&job.ready, &job.lock);
+		if (job.quit) {
+			mtx_unlock(&job.lock);
+			return 0;
+		}
+		int type = job.type;
+		Position p = job.pos;
+		SearchLimits l = job.limits;
+		int multiPv = job.multiPv;
+		mtx_unlock(&job.lock);
+
+		if (type == JOB_GO) runGo(&p, &l);
+		else if (type == JOB_HINT) runHint(&p, &l, multiPv);
+		else {
+			SearchResult result;
+			l.msec = PONDER_MSEC;
+			l.maxDepth = ALPHABETAHEIGHT;
+			l.ponder = 1;
+			searchPosition(&p, &l, &result);					// the transposition table keeps what it finds
+		}
+
+		mtx_lock(&job.lock);
+		job.type = JOB_NONE;
+		cnd_broadcast(&job.idle);
+		mtx_unlock(&job.lock);
+	}
+}
+
+//@@***********************************************************************************@@
+// hand a job to the worker, which has to be idle
+void startJob(int type, Position* p, SearchLimits* l, int multiPv) {
+	mtx_lock(&job.lock);
+	job.type = type;
+	job.pos = *p;
+	job.limits = *l;
+	job.multiPv = multiPv;
+	atomic_store(&job.cancel, 0);
+	cnd_signal(&job.ready);
+	mtx_unlock(&job.lock);
+}
+
+//@@***********************************************************************************@@
+// cancel the ponder search, or any search when all is set, and wait until the worker is idle. A
+// cancelled go still answers with the move of its last finished depth
+void stopJob(int all) {
+	mtx_lock(&job.lock);
+	if (job.type == JOB_PONDER || (all && job.type != JOB_NONE)) atomic_store(&job.cancel, 1);
+	while (job.type != JOB_NONE) cnd_wait(&job.idle, &job.lock);
+	mtx_unlock(&job.lock);
+}
+
+//@@***********************************************************************************@@
+// search the best move and answer with === move/eval/seconds, PA when the side to move has to pass
+void runGo(Position* p, SearchLimits* l) {
+	SearchResult result;
+	char name[16];
+	reply("status Thinking\n");
+	int move = searchPosition(p, l, &result);
+	uint64_t moves = getMoves(p->board.player, p->board.opponent);
+	if (move == -1 && moves) move = lowestBit(moves);			// stopped before the first depth was done
+	nboardMove(move, name);
+	reply("nodestats %lld %.2f\n", result.nodes, result.msec / 1000.0);
+	reply("=== %s/%.2f/%.2f\n", name, circles(result.score, result.exact), result.msec / 1000.0);
+	reply("status\n");
+}
+
+//@@***********************************************************************************@@
+// stream the scores of the best multiPv moves after every iteration
+void runHint(Position* p, SearchLimits* l, int multiPv) {
+	Analysis* a = (Analysis*)malloc(sizeof(Analysis));
+	if (!a) return;
+	reply("status Analyzing\n");
+	analyzePosition(p, l, multiPv, a, reportHint, NULL);
+	reply("nodestats %lld %.2f\n", a->nodes, a->msec / 1000.0);
+	reply("status\n");
+	free(a);
+}
+
+//@@***********************************************************************************@@
+// write one search line per analysed move: the pv, the eval in circles, 0 and the depth (100% when
+// exact)
+void reportHint(Analysis* a, void* data) {
+	(void)data;
+	char pv[3 * STATS_PLY + 1];
+	char name[16];
+	char depth[16];
+	if (a->exact) strcpy(depth, "100%");
+	else sprintf(depth, "%d", a->depth);
+	for (int i = 0; i < a->count; i++) {
+		MoveAnalysis* m = &a->moves[i];
+		pv[0] = '\0';
+		for (int j = 0; j < m->pvLength; j++) {
+			nboardMove(m->pv[j], name);
+			strcat(pv, name);
+		}
+		reply("search %s %.2f 0 %s\n", pv, circles(m->score, a->exact), depth);
+	}
+}
+
+//@@***********************************************************************************@@
+// write one answer line and flush it, the worker and the reader both answer
+void reply(const char* format, ...) {
+	va_list args;
+	va_start(args, format);
+	mtx_lock(&outputLock);
+	vprintf(format, args);
+	fflush(stdout);
+	mtx_unlock(&outputLock);
+	va_end(args);
+}
+
+//@@***********************************************************************************@@
+// read a GGF game like (;GM[Othello]...BO[8 <board> *]B[F5//1.2]W[D6];): the board of the BO tag, then
+// every B and W move in order, a pass that is left out is played. Return 0 if it is not a valid game
+int parseGame(char* s, Position* p) {
+	int board = 0;
+	while (*s) {
+		if (!isupper((unsigned char)*s)) {
+			s++;
+			continue;
+		}
+		char tag[8];
+		int n = 0;
+		for (; isupper((unsigned char)*s); s++) {
+			if (n < 7) tag[n++] = *s;
+		}
+		tag[n] = '\0';
+		if (*s != '[') continue;
+		char* value = ++s;
+		while (*s && *s != ']') s++;
+		if (!*s) return 0;
+		*s++ = '\0';
+
+		if (strcmp(tag, "BO") == 0) {
+			while (isdigit((unsigned char)*value) || *value == ' ') value++;	// the board size
+			if (!readPosition(value, p)) return 0;
+			board = 1;
+		}
+		else if (board && (strcmp(tag, "B") == 0 || strcmp(tag, "W") == 0)) {
+			int move = readMove(value);
+			if (move == -2) return 0;
+			if ((tag[0] == 'B') != (p->identity == 0)) makePass(p);	// the other side passed
+			if (!playMove(p, move)) return 0;
+		}
+	}
+	return board;
+}
+
+//@@***********************************************************************************@@
+// play a move or a pass on the position, a pass that the GUI left out before the move is played too.
+// Return 0 if it is not legal, the position may have passed then
+int playMove(Position* p, int move) {
+	uint64_t moves = getMoves(p->board.player, p->board.opponent);
+	if (move == -2) return 0;
+	if (move == -1) {
+		if (moves) return 0;
+		makePass(p);
+		return 1;
+	}
+	if (!((moves >> move) & 1)) {
+		if (moves) return 0;
+		makePass(p);
+		if (!((getMoves(p->board.player, p->board.opponent) >> move) & 1)) return 0;
+	}
+	Undo u;
+	makeMove(p, move, &u);
+	return 1;
+}
+
+//@@***********************************************************************************@@
+// write the move in the NBoard notation, the move of moveName with a capital letter (A1 - H8), PA for a pass
+void nboardMove(int move, char* name) {
+	if (move < 0) strcpy(name, "PA");
+	else {
+		moveName(move, name);
+		name[0] = toupper((unsigned char)name[0]);
+	}
+}
+
+//@@***********************************************************************************@@
+// score of the search in circles, an exact score already is the circle difference. A game that the
+// search saw finished scores its final difference plus WIN_BONUS, the bonus is taken off first
+double circles(int score, int exact) {
+	if (exact) return score;
+	if (score > WIN_BONUS) score -= WIN_BONUS;
+	else if (score < -WIN_BONUS) score += WIN_BONUS;
+	return (double)score / evaluationUnit();
+}
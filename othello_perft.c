@@ -0,0 +1,242 @@
+/*
+*** FILE NAME   : othello_perft.c
+*** PURPOSE		: Counts the move paths of the move generator (perft) to check it and to measure its speed
+*** DESCRIPTION : perft(n) is the number of paths of n plies from a position. A pass takes one ply
+				  and a finished game counts as one path at whatever ply it ends. Without arguments
+				  the start position is counted to PERFT_DEPTH plies and a few stored positions to
+				  their own depths, and every count is compared with the known-correct one. The
+				  nodes per second of every count is printed, and the program returns 1 when any
+				  count is wrong so it can be used as a check before a change of the move generator
+				  is merged.
+				  Options: -depth <n> (depth of the start position), -full (make the moves of the
+				  last ply too instead of counting them), -simd <level> (fastest move kernels to use:
+				  0 scalar, 1 AVX2, 2 AVX-512, the cpu may support less), -size <n> (count the start
+				  position of the 6x6, 8x8 or 10x10 board with the kernels of sizeSelect instead),
+				  [file] (positions to count instead of the stored ones, each line: a position as read
+				  by readPosition, depth and the expected count, the count may be left out)
+*/
+
+#include <stdio.h>						// standard C libraries
+#include <stdlib.h>
+#include <string.h>
+#include "othello_engine.h"				// rules of the game
+
+
+//@@***********************************************************************************@@
+// Constants
+#define PERFT_DEPTH 11					// default depth of the start position
+#define LINE_SIZE 256					// longest input line
+
+
+//@@***********************************************************************************@@
+// Structs
+
+// The known perft counts of the start position of a board size
+typedef struct sizeCounts {
+	int size;							// blocks on a side
+	int known;							// number of known counts, from depth 0
+	long long count[16];				// the correct count of every depth
+} SizeCounts;
+
+// A position with its known perft count
+typedef struct perftCase {
+	Position position;					// the position to count
+	int depth;							// plies to count
+	long long count;					// the correct count, -1 if unknown
+} PerftCase;
+
+
+//@@***********************************************************************************@@
+// Global variables
+
+// perft of the start position for every depth (OEIS A124004)
+long long startCounts[] = { 1, 4, 12, 56, 244, 1396, 8200, 55092, 390216, 3005288, 24571284,
+	212258800, 1939886636, 18429641748LL };
+
+// perft of the start position of every board size of sizeSelect, the 6x6 and 10x10 counts were checked
+// with the plain rules on an array board
+SizeCounts sizeCounts[] = {
+	{ 6, 13, { 1, 4, 12, 56, 244, 1364, 7604, 47740, 308716, 2114912, 14976792, 108820292, 811201176 } },
+	{ 8, 14, { 1, 4, 12, 56, 244, 1396, 8200, 55092, 390216, 3005288, 24571284, 212258800, 1939886636, 18429641748LL } },
+	{ 10, 12, { 1, 4, 12, 56, 244, 1396, 8200, 55180, 392268, 3045812, 25168320, 221261132 } },
+};
+
+// midgame and endgame positions, with passes and finished games inside their trees, in the form of
+// the position files
+const char* storedCases[] = {
+	"----O-----XOO----OOX-----OOXX----O-XO-O---XXXOO---XX--O---X----- X 7 47648375",
+	"-X-OO----XOOO----XOOOOO-XXOOOOO--XXOOXO-OXOOOOO-XOOXOOO--OOOO--- X 7 5040582",
+	"OOOOOOO--O-OOO--OOOXOXX--OOXXX--OOOXXXO--O-XXX-O-OOXXOO----X--XO X 8 20337447",
+	"---X-O---XXXX---XXXOXX--XXXXXXX-XXXOXX-OXOXOXXOOXOOOOOOOXXXXXOOO X 9 663610",		// black has to pass
+	"XX------XXX-X---XXXXX-XO--XXXXOOXXXXXOX-OOOXOXX-OOOOXXX-XOOOOOOO X 9 2320167",		// black has to pass
+};
+
+
+//@@***********************************************************************************@@
+// Function
+
+long long perft(Position* p, int depth, int full);			// count the paths of depth plies from the position
+int parseCase(const char* line, PerftCase* pc);				// read a position with its depth and count, return 0 if not one
+int runCase(PerftCase* pc, int full);						// count one position and print the result, return 0 if the count is wrong
+int runSize(const SizeKernels* k, int depth, long long* nodes);	// count the start position of a board size to every depth, return the wrong counts
+
+
+//@@***********************************************************************************@@
+int main(int argc, char **argv)
+{
+	// optional arguments: -depth <n>, -full, -simd <level>, -size <n>, [file]
+	int depth = PERFT_DEPTH;
+	int full = 0;
+	int simd = SIMD_AVX512;
+	int size = 0;
+	char* fileName = NULL;
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "-full") == 0) full = 1;
+		else if (argv[i][0] != '-') fileName = argv[i];
+		else if (i + 1 >= argc) break;
+		else if (strcmp(argv[i], "-depth") == 0) depth = atoi(argv[++i]);
+		else if (strcmp(argv[i], "-simd") == 0) simd = atoi(argv[++i]);
+		else if (strcmp(argv[i], "-size") == 0) size = atoi(argv[++i]);
+	}
+	if (!engineInit(1)) return 1;
+	const char* kernels[] = { "scalar", "AVX2", "AVX-512" };
+	printf("kernels %s\n", kernels[simdSelect(simd)]);
+
+	int failed = 0;
+	long long nodes = 0;
+	long long start = currentMsec();
+	if (size) {
+		// the start position of a board size with its own kernels
+		const SizeKernels* k = sizeSelect(size);
+		if (!k) {
+			fprintf(stderr, "The board size %d is not supported.\n", size);
+			return 1;
+		}
+		failed += runSize(k, depth, &nodes);
+	}
+	else if (fileName) {
+		// positions of the file
+		FILE* in = fopen(fileName, "r");
+		char line[LINE_SIZE];
+		PerftCase pc;
+		if (!in) {
+			fprintf(stderr, "Cannot open %s.\n", fileName);
+			return 1;
+		}
+		while (fgets(line, sizeof(line), in)) {
+			if (!parseCase(line, &pc)) continue;
+			failed += !runCase(&pc, full);
+			nodes += pc.count;
+		}
+		fclose(in);
+	}
+	else {
+		// the start position to every depth, then the stored positions
+		for (int d = 1; d <= depth; d++) {
+			PerftCase pc = { .depth = d, .count = d < (int)(sizeof(startCounts) / sizeof(startCounts[0])) ? startCounts[d] : -1 };
+			startPosition(&pc.position, 0);
+			failed += !runCase(&pc, full);
+			nodes += pc.count;
+		}
+		for (int i = 0; i < (int)(sizeof(storedCases) / sizeof(storedCases[0])); i++) {
+			PerftCase pc;
+			parseCase(storedCases[i], &pc);
+			failed += !runCase(&pc, full);
+			nodes += pc.count;
+		}
+	}
+
+	long long msec = currentMsec() - start;
+	printf("%s leaves %lld msec %lld nps %lld\n", failed ? "FAILED" : "passed", nodes, msec, msec > 0 ? nodes * 1000 / msec : 0);
+	return failed ? 1 : 0;
+}
+
+//@@***********************************************************************************@@
+// count the paths of depth plies from the position, a pass takes one ply and a finished game is
+// one path. Without full the moves of the last ply are counted instead of made
+long long perft(Position* p, int depth, int full) {
+	if (depth == 0) return 1;
+
+	uint64_t moves = getMoves(p->board.player, p->board.opponent);
+	if (!moves) {
+		if (!getMoves(p->board.opponent, p->board.player)) return 1;		// the game is over
+		makePass(p);
+		long long n = perft(p, depth - 1, full);
+		makePass(p);
+		return n;
+	}
+	if (depth == 1 && !full) return popCount(moves);
+
+	long long n = 0;
+	Undo u;
+	for (; moves; moves &= moves - 1) {
+		makeMove(p, lowestBit(moves), &u);
+		n += perft(p, depth - 1, full);
+		undoMove(p, &u);
+	}
+	return n;
+}
+
+//@@***********************************************************************************@@
+// read a line "board side depth [count]" with readPosition, return 0 if the line is blank, a comment or
+// not a position
+int parseCase(const char* line, PerftCase* pc) {
+	while (*line == ' ' || *line == '\t') line++;
+	if (*line == '#' || *line == '\n' || *line == '\r' || *line == '\0') return 0;
+	pc->count = -1;
+	const char* rest = readPosition(line, &pc->position);
+	if (!rest || sscanf(rest, "%d %lld", &pc->depth, &pc->count) < 1) {
+		fprintf(stderr, "Skipped a line that is not a position: %s", line);
+		return 0;
+	}
+	return 1;
+}
+
+//@@***********************************************************************************@@
+// count one position, print the count with its speed and replace the expected count with the
+// counted one, return 0 if it differs from the expected count
+int runCase(PerftCase* pc, int full) {
+	Position p = pc->position;
+	uint64_t black = p.identity == 0 ? p.board.player : p.board.opponent;
+	uint64_t white = p.identity == 0 ? p.board.opponent : p.board.player;
+	char board[BOARD_SIZE * BOARD_SIZE + 1];
+	for (int x = 0; x < BOARD_SIZE * BOARD_SIZE; x++) board[x] = (black >> x) & 1 ? 'X' : ((white >> x) & 1 ? 'O' : '-');
+	board[BOARD_SIZE * BOARD_SIZE] = '\0';
+
+	long long start = currentMsec();
+	long long n = perft(&p, pc->depth, full);
+	long long msec = currentMsec() - start;
+	int ok = pc->count < 0 || n == pc->count;
+
+	printf("%s %c depth %d leaves %lld msec %lld nps %lld%s\n", board, p.identity ? 'O' : 'X', pc->depth, n, msec,
+		msec > 0 ? n * 1000 / msec : 0, pc->count < 0 ? "" : (ok ? " ok" : " WRONG"));
+	if (!ok) printf("expected %lld\n", pc->count);
+	pc->count = n;
+	return ok;
+}
+
+//@@***********************************************************************************@@
+// count the start position of a board size to every depth with the kernels of the size, print the counts
+// with their speed and return the number of counts that differ from the known ones
+int runSize(const SizeKernels* k, int depth, long long* nodes) {
+	const SizeCounts* known = NULL;
+	for (int i = 0; i < (int)(sizeof(sizeCounts) / sizeof(sizeCounts[0])); i++) {
+		if (sizeCounts[i].size == k->size) known = &sizeCounts[i];
+	}
+
+	int failed = 0;
+	for (int d = 1; d <= depth; d++) {
+		long long count = known && d < known->known ? known->count[d] : -1;
+		long long start = currentMsec();
+		long long n = k->perft(k->startBlack, k->startWhite, d);
+		long long msec = currentMsec() - start;
+		int ok = count < 0 || n == count;
+
+		printf("size %d depth %d leaves %lld msec %lld nps %lld%s\n", k->size, d, n, msec, msec > 0 ? n * 1000 / msec : 0,
+			count < 0 ? "" : (ok ? " ok" : " WRONG"));
+		if (!ok) printf("expected %lld\n", count);
+		failed += !ok;
+		*nodes += n;
+	}
+	return failed;
+}
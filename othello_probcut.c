@@ -0,0 +1,350 @@
+/*
+*** FILE NAME   : othello_probcut.c
+*** PURPOSE		: Fits the multi-probcut parameters of the search to search logs and writes the parameters file
+*** DESCRIPTION : Multi-probcut predicts the score of a deep search of a position from a shallow one: the
+				  difference deep - shallow has a mean and a standard deviation for every game phase and
+				  pair of depths, which this program measures. Each line of the input files is one of:
+				    - a search log: 64 board characters (X: black, O: white, -: empty), the side to move
+				      and the scores of the position searched to depth 0, 1, 2, ... (as written by -log)
+				    - a position: the board and the side to move, it is searched to -depth
+				    - a game record like f5d6c3d3 (passes are left out), every -sample th position of
+				      the game with more than -depth empties is searched
+				  The positions are searched without multi-probcut and without the exact solver, one per
+				  thread with -threads threads that share the transposition table (each search with its
+				  own keys, so no search sees the results of another), and the score of every
+				  iteration is kept. -log <file> appends the scores as search logs, so the fit can be run
+				  again on more positions without searching the old ones. Pairs with fewer than
+				  PROBCUT_SAMPLES positions are left out. The parameters are written for the current
+				  evaluation (the default weights or -eval <file>) in the format of probcutLoad.
+				  Options: -depth <n>, -sample <n>, -max <positions>, -threads <n>, -hash <MB>,
+				  -eval <file>, -log <file>, -out <file>, files...
+*/
+
+#include <stdio.h>						// standard C libraries
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <threads.h>
+#include "othello_engine.h"				// rules and search of the ai
+
+
+//@@***********************************************************************************@@
+// Constants
+#define PROBCUT_DEPTH 10				// default deepest search of every position
+#define PROBCUT_SAMPLE 4				// default distance in plies between the searched positions of a game
+#define PROBCUT_SAMPLES 30				// fewest positions that fit a pair
+#define LINE_SIZE 1024					// longest input line
+
+
+//@@***********************************************************************************@@
+// Structs
+
+// Sums of deep - shallow of every (phase, deep, shallow) pair
+typedef struct pairSums {
+	double n[PROBCUT_PHASES][PROBCUT_DEPTHS][PROBCUT_DEPTHS];		// number of positions
+	double sum[PROBCUT_PHASES][PROBCUT_DEPTHS][PROBCUT_DEPTHS];		// sum of the differences
+	double squares[PROBCUT_PHASES][PROBCUT_DEPTHS][PROBCUT_DEPTHS];	// sum of the squared differences
+} PairSums;
+
+// The input that the workers share, read, logged and counted under the lock
+typedef struct fitInput {
+	char** files;						// the input files
+	int fileNum;
+	int file;							// the file being read
+	FILE* in;							// the open file, NULL before the first one
+	FILE* log;							// the searched scores are appended to it, NULL if not used
+	SearchLimits limits;				// limits of the searches
+	int sample;							// distance in plies between the searched positions of a game
+	int maxPositions;					// positions to search at most, 0 for no limit
+	int positions;						// positions fitted
+	int searched;						// positions searched
+	long long nodes;					// nodes of the searches
+	mtx_t lock;
+} FitInput;
+
+// A thread and its sums
+typedef struct fitWorker {
+	FitInput* input;
+	PairSums* sums;
+} FitWorker;
+
+
+//@@***********************************************************************************@@
+// Function
+
+int fitThread(void* arg);									// thread entry, fit the lines of the input until it ends
+int nextLine(FitInput* input, char* line);					// read the next line of the files, return 0 at the end
+void fitLine(FitWorker* w, char* line);						// fit the search log, the position or the game record of a line
+void fitPosition(FitWorker* w, uint64_t black, uint64_t white, int identity);	// search a position and fit its scores
+void addScores(PairSums* sums, int discs, int scores[], int depths);	// add every pair of the scores of a position
+
+
+//@@***********************************************************************************@@
+int main(int argc, char **argv)
+{
+	// optional arguments: see the description above
+	FitInput input;
+	int threads = 1;
+	int hashMB = HASH_MB;
+	char* evalFile = NULL;
+	char* logFile = NULL;
+	char* outFile = PROBCUT_FILE;
+	memset(&input, 0, sizeof(input));
+	input.files = (char**)malloc(argc * sizeof(char*));
+	input.sample = PROBCUT_SAMPLE;
+	defaultLimits(&input.limits);
+	input.limits.maxDepth = PROBCUT_DEPTH;
+	input.limits.msec = 1 << 30;										// the depth is the only limit
+	input.limits.endgameEmpties = 0;
+	input.limits.probcut = 0;
+	int size = 8;
+	for (int i = 1; i < argc; i++) {
+		if (argv[i][0] != '-') input.files[input.fileNum++] = argv[i];
+		else if (i + 1 >= argc) break;
+		else if (strcmp(argv[i], "-depth") == 0) input.limits.maxDepth = atoi(argv[++i]);
+		else if (strcmp(argv[i], "-sample") == 0) input.sample = atoi(argv[++i]);
+		else if (strcmp(argv[i], "-max") == 0) input.maxPositions = atoi(argv[++i]);
+		else if (strcmp(argv[i], "-threads") == 0) threads = atoi(argv[++i]);
+		else if (strcmp(argv[i], "-hash") == 0) hashMB = atoi(argv[++i]);
+		else if (strcmp(argv[i], "-eval") == 0) evalFile = argv[++i];
+		else if (strcmp(argv[i], "-log") == 0) logFile = argv[++i];
+		else if (strcmp(argv[i], "-out") == 0) outFile = argv[++i];
+		else if (strcmp(argv[i], "-size") == 0) size = atoi(argv[++i]);
+	}
+	if (size != 8) {												// the ProbCut pairs are fitted to the 8x8 search
+		fprintf(stderr, "othello_probcut works on the 8x8 board only, -size %d is not supported.\n", size);
+		return 1;
+	}
+	if (input.limits.maxDepth < 1) input.limits.maxDepth = 1;
+	if (input.limits.maxDepth >= PROBCUT_DEPTHS) input.limits.maxDepth = PROBCUT_DEPTHS - 1;
+	if (input.sample < 1) input.sample = 1;
+	if (threads < 1) threads = 1;
+	if (threads > MAX_THREADS) threads = MAX_THREADS;
+	if (!engineInit(hashMB)) {
+		fprintf(stderr, "Cannot allocate %d MB for the transposition table.\n", hashMB);
+		return 1;
+	}
+	if (!evalFile) patternLoad(PATTERN_FILE);					// the default weights are optional
+	else if (!patternLoad(evalFile)) {
+		fprintf(stderr, "Cannot load the weights from %s.\n", evalFile);
+		return 1;
+	}
+	if (input.fileNum == 0) {
+		fprintf(stderr, "No input files.\n");
+		return 1;
+	}
+	if (logFile && !(input.log = fopen(logFile, "a"))) {
+		fprintf(stderr, "Cannot open %s.\n", logFile);
+		return 1;
+	}
+	if (mtx_init(&input.lock, mtx_plain) != thrd_success) return 1;
+
+	// the calling thread is the first worker
+	FitWorker* workers = (FitWorker*)calloc(threads, sizeof(FitWorker));
+	thrd_t* ids = (thrd_t*)malloc(threads * sizeof(thrd_t));
+	if (!workers || !ids) {
+		fprintf(stderr, "Out of memory.\n");
+		return 1;
+	}
+	for (int t = 0; t < threads; t++) {
+		workers[t].input = &input;
+		if (!(workers[t].sums = (PairSums*)calloc(1, sizeof(PairSums)))) {
+			fprintf(stderr, "Out of memory.\n");
+			return 1;
+		}
+	}
+	long long start = currentMsec();
+	int started = 1;
+	for (; started < threads; started++) {
+		if (thrd_create(&ids[started], fitThread, &workers[started]) != thrd_success) break;
+	}
+	fitThread(&workers[0]);
+	for (int t = 1; t < started; t++) thrd_join(ids[t], NULL);
+	if (input.in) fclose(input.in);
+	if (input.log) fclose(input.log);
+	long long msec = currentMsec() - start;
+	printf("positions %d searched %d nodes %lld msec %lld\n", input.positions, input.searched, input.nodes, msec);
+
+	// the mean and sigma of every pair from the sums of all the threads
+	ProbcutPair* table = (ProbcutPair*)calloc((size_t)PROBCUT_PHASES * PROBCUT_DEPTHS * PROBCUT_DEPTHS, sizeof(ProbcutPair));
+	if (!table) {
+		fprintf(stderr, "Out of memory.\n");
+		return 1;
+	}
+	for (int phase = 0; phase < PROBCUT_PHASES; phase++) {
+		for (int deep = 1; deep < PROBCUT_DEPTHS; deep++) {
+			for (int shallow = 0; shallow < deep; shallow++) {
+				double n = 0, sum = 0, squares = 0;
+				for (int t = 0; t < threads; t++) {
+					n += workers[t].sums->n[phase][deep][shallow];
+					sum += workers[t].sums->sum[phase][deep][shallow];
+					squares += workers[t].sums->squares[phase][deep][shallow];
+				}
+				if (n < PROBCUT_SAMPLES) continue;
+				double mean = sum / n;
+				double variance = squares / n - mean * mean;
+				ProbcutPair* pc = &table[((size_t)phase * PROBCUT_DEPTHS + deep) * PROBCUT_DEPTHS + shallow];
+				pc->mean = (float)mean;
+				pc->sigma = (float)sqrt(variance > 0 ? variance : 0) + 0.5f;	// never 0, a fitted pair is always used
+			}
+		}
+	}
+
+	// the pairs the search uses: the check at a half of the depth in every phase
+	printf("depth shallow");
+	for (int phase = 0; phase < PROBCUT_PHASES; phase++) printf("  phase %d (mean sigma)", phase);
+	printf("\n");
+	for (int deep = PROBCUT_MIN_DEPTH; deep <= input.limits.maxDepth; deep++) {
+		int shallow = probcutShallow(deep, 1);
+		printf("%5d %7d", deep, shallow);
+		for (int phase = 0; phase < PROBCUT_PHASES; phase++) {
+			ProbcutPair* pc = &table[((size_t)phase * PROBCUT_DEPTHS + deep) * PROBCUT_DEPTHS + shallow];
+			printf("  %10.2f %10.2f", pc->mean, pc->sigma);
+		}
+		printf("\n");
+	}
+	if (!probcutSave(outFile, table)) {
+		fprintf(stderr, "Cannot write %s.\n", outFile);
+		return 1;
+	}
+	printf("parameters written to %s\n", outFile);
+	return 0;
+}
+
+//@@***********************************************************************************@@
+// thread entry, fit the lines of the input one by one until the input or the positions run out
+int fitThread(void* arg) {
+	FitWorker* w = (FitWorker*)arg;
+	char line[LINE_SIZE];
+	while (nextLine(w->input, line)) fitLine(w, line);
+	return 0;
+}
+
+//@@***********************************************************************************@@
+// read the next line of the input files, return 0 when they end or enough positions were searched
+int nextLine(FitInput* input, char* line) {
+	int found = 0;
+	mtx_lock(&input->lock);
+	while (!found && (input->maxPositions <= 0 || input->searched < input->maxPositions)) {
+		if (input->in && fgets(line, LINE_SIZE, input->in)) found = 1;
+		else {
+			if (input->in) fclose(input->in);
+			input->in = NULL;
+			if (input->file >= input->fileNum) break;
+			if (!(input->in = fopen(input->files[input->file], "r"))) fprintf(stderr, "Cannot open %s.\n", input->files[input->file]);
+			input->file++;
+		}
+	}
+	mtx_unlock(&input->lock);
+	return found;
+}
+
+//@@***********************************************************************************@@
+// fit one line: the scores of a search log, a position that is searched, or the positions of a game
+void fitLine(FitWorker* w, char* line) {
+	while (*line == ' ' || *line == '\t') line++;
+	if (*line == '#' || *line == '\n' || *line == '\r' || *line == '\0') return;
+
+	// a search log or a position
+	Position p;
+	Undo u;
+	int x;
+	const char* s = readPosition(line, &p);
+	if (s) {
+		uint64_t black = p.identity == 0 ? p.board.player : p.board.opponent;
+		uint64_t white = p.identity == 0 ? p.board.opponent : p.board.player;
+		int identity = p.identity;
+		int n = 0;
+		int scores[PROBCUT_DEPTHS];
+		int depths = 0;
+		for (; depths < PROBCUT_DEPTHS && sscanf(s, "%d%n", &scores[depths], &n) == 1; s += n) depths++;
+		if (depths >= 2) {
+			mtx_lock(&w->input->lock);
+			w->input->positions++;
+			mtx_unlock(&w->input->lock);
+			addScores(w->sums, popCount(black | white), scores, depths);
+		}
+		else fitPosition(w, black, white, identity);
+		return;
+	}
+
+	// a game record, every sample th position with more empties than the depth is searched
+	startPosition(&p, 0);
+	int ply = 0;
+	for (char* s = line; (x = readMove(s)) >= 0; s += 2, ply++) {
+		uint64_t moves = getMoves(p.board.player, p.board.opponent);
+		if (!moves) {													// passes are not written in the record
+			makePass(&p);
+			moves = getMoves(p.board.player, p.board.opponent);
+		}
+		if (!((moves >> x) & 1)) return;								// not a legal game
+		if (ply % w->input->sample == 0 && popCount(~(p.board.player | p.board.opponent)) > w->input->limits.maxDepth) {
+			uint64_t black = p.identity == 0 ? p.board.player : p.board.opponent;
+			uint64_t white = p.identity == 0 ? p.board.opponent : p.board.player;
+			fitPosition(w, black, white, p.identity);
+		}
+		makeMove(&p, x, &u);
+	}
+}
+
+//@@***********************************************************************************@@
+// search a position to the depth limit and fit the score of every iteration, positions without moves
+// or too close to the end are skipped
+void fitPosition(FitWorker* w, uint64_t black, uint64_t white, int identity) {
+	FitInput* input = w->input;
+	Position p;
+	SearchResult result;
+	int scores[PROBCUT_DEPTHS];
+
+	setPosition(&p, black, white, identity);
+	if (popCount(~(black | white)) <= input->limits.maxDepth || !getMoves(p.board.player, p.board.opponent)) return;
+	mtx_lock(&input->lock);
+	int skip = input->maxPositions > 0 && input->searched >= input->maxPositions;
+	if (!skip) input->searched++;
+	uint64_t salt = (uint64_t)input->searched * 0x9E3779B97F4A7C15ULL;
+	mtx_unlock(&input->lock);
+	if (skip) return;
+
+	// the keys of every search are changed by their own salt, so the shared table holds a table of its own
+	// for each search: a shallow iteration never finds the deeper result of an overlapping position that
+	// another thread or an earlier search stored, which would pull deep - shallow towards 0
+	p.hash ^= salt;
+	scores[0] = evaluate(&p);
+	searchPosition(&p, &input->limits, &result);
+	int depths = 1;
+	while (depths <= result.stats.iterations && depths < PROBCUT_DEPTHS) {
+		scores[depths] = result.stats.iterScore[depths];
+		depths++;
+	}
+	addScores(w->sums, popCount(black | white), scores, depths);
+
+	mtx_lock(&input->lock);
+	input->positions++;
+	input->nodes += result.nodes;
+	if (input->log) {
+		for (int x = 0; x < BOARD_SIZE * BOARD_SIZE; x++) fputc((black >> x) & 1 ? 'X' : ((white >> x) & 1 ? 'O' : '-'), input->log);
+		fprintf(input->log, " %c", identity == 0 ? 'X' : 'O');
+		for (int d = 0; d < depths; d++) fprintf(input->log, " %d", scores[d]);
+		fprintf(input->log, "\n");
+		fflush(input->log);
+	}
+	mtx_unlock(&input->lock);
+}
+
+//@@***********************************************************************************@@
+// add deep - shallow of every pair of the scores (scores[d] is the score at depth d) to the sums of the
+// phase, a score of a finished game (with the win bonus) would only add noise and ends the list
+void addScores(PairSums* sums, int discs, int scores[], int depths) {
+	int phase = probcutPhase(discs);
+	for (int d = 0; d < depths; d++) {
+		if (scores[d] >= WIN_BONUS / 2 || scores[d] <= -WIN_BONUS / 2) depths = d;
+	}
+	for (int deep = 1; deep < depths; deep++) {
+		for (int shallow = 0; shallow < deep; shallow++) {
+			double diff = scores[deep] - scores[shallow];
+			sums->n[phase][deep][shallow] += 1;
+			sums->sum[phase][deep][shallow] += diff;
+			sums->squares[phase][deep][shallow] += diff * diff;
+		}
+	}
+}
@@ -0,0 +1,490 @@
+/*
+*** FILE NAME   : othello_size.h
+*** PURPOSE		: Rules and search of one board size, generated for every size that sizeSelect serves
+*** DESCRIPTION : othello_engine.c includes this file once for every board size with SIZE_N (blocks on a
+				  side), SIZE_MASK (an unsigned type of SIZE_N * SIZE_N bits or more), SIZE_COUNT and
+				  SIZE_LOWEST (popCount and lowestBit of a SIZE_MASK) defined, and SIZE_ENGINE when the
+				  8x8 engine already has the move kernels and the search of the size. Every function
+				  and table gets the size in its name (sizeMoves6, sizeValue10, ...), the wrap masks and
+				  the shifts are constants of the size and a line holds at most SIZE_N - 2 circles, so
+				  the code of a size has no size checks left. The kernels work on the SIZE_MASK of the
+				  size, only the functions of its SizeKernels convert from and to a WideMask.
+*/
+
+#define SIZE_NAME(f) SIZE_PASTE(f, SIZE_N)
+#define SIZE_BLOCKS (SIZE_N * SIZE_N)
+#define SIZE_BIT(x) ((SIZE_MASK)1 << (x))
+#define SIZE_ALL ((SIZE_MASK)~(SIZE_MASK)0 >> (sizeof(SIZE_MASK) * 8 - SIZE_BLOCKS))	// every block of the board
+#define SIZE_FIRST_COLUMN (SIZE_ALL / (SIZE_BIT(SIZE_N) - 1))							// bit 0 of every row
+#define SIZE_LAST_COLUMN (SIZE_FIRST_COLUMN << (SIZE_N - 1))
+#define SIZE_CENTER (SIZE_N / 2)
+#define SIZE_START_BLACK (SIZE_BIT((SIZE_CENTER - 1) * SIZE_N + SIZE_CENTER) | SIZE_BIT(SIZE_CENTER * SIZE_N + SIZE_CENTER - 1))
+#define SIZE_START_WHITE (SIZE_BIT((SIZE_CENTER - 1) * SIZE_N + SIZE_CENTER - 1) | SIZE_BIT(SIZE_CENTER * SIZE_N + SIZE_CENTER))
+
+int SIZE_NAME(sizeValue)[SIZE_BLOCKS];	// sizeMoveValue of every block
+
+//@@***********************************************************************************@@
+// fill the square values of the size
+void SIZE_NAME(sizeInit)() {
+	for (int x = 0; x < SIZE_BLOCKS; x++) SIZE_NAME(sizeValue)[x] = sizeMoveValue(SIZE_N, x / SIZE_N, x % SIZE_N);
+}
+
+#ifdef SIZE_ENGINE
+#define SIZE_MOVES getMoves
+#define SIZE_FLIPS getFlips
+#define SIZE_SEARCH sizeSearchEngine
+#else
+#define SIZE_MOVES SIZE_NAME(sizeMoves)
+#define SIZE_FLIPS SIZE_NAME(sizeFlips)
+#define SIZE_SEARCH SIZE_NAME(sizeSearchWide)
+
+// the lines of o that start next to the circles of p in one direction (up) and in the opposite one
+// (down). The next block of a line is k bits higher or lower, om is o without the columns where a line of
+// the direction cannot go on, so no bit wraps to the other side of the board. After 2 single steps every
+// step adds 2 blocks through the pairs of o, a line holds at most SIZE_N - 2 circles. A macro, so every
+// direction gets its shifts as constants
+#define SIZE_LINES(up, down, p, om, k) {												\
+	SIZE_MASK upPairs = (om) & ((om) << (k)), downPairs = (om) & ((om) >> (k));			\
+	up = ((p) << (k)) & (om);															\
+	down = ((p) >> (k)) & (om);															\
+	up |= (up << (k)) & (om);															\
+	down |= (down >> (k)) & (om);														\
+	for (int i = 0; i < (SIZE_N - 3) / 2; i++) {										\
+		up |= upPairs & (up << 2 * (k));												\
+		down |= downPairs & (down >> 2 * (k));											\
+	}																					\
+}
+
+// the line when the block after it (next) holds a circle of p, otherwise nothing
+#define SIZE_CLOSED(line, next, p) ((line) & -(SIZE_MASK)(((next) & (p)) != 0))
+
+//@@***********************************************************************************@@
+// generate all the valid moves of p against o: the empty block after a line of o in the rows, the
+// columns and both diagonals
+SIZE_MASK SIZE_NAME(sizeMoves)(SIZE_MASK p, SIZE_MASK o) {
+	SIZE_MASK inner = o & ~(SIZE_FIRST_COLUMN | SIZE_LAST_COLUMN);
+	SIZE_MASK moves = 0, up, down;
+	SIZE_LINES(up, down, p, inner, 1);
+	moves |= (up << 1) | (down >> 1);
+	SIZE_LINES(up, down, p, o, SIZE_N);
+	moves |= (up << SIZE_N) | (down >> SIZE_N);
+	SIZE_LINES(up, down, p, inner, SIZE_N + 1);
+	moves |= (up << (SIZE_N + 1)) | (down >> (SIZE_N + 1));
+	SIZE_LINES(up, down, p, inner, SIZE_N - 1);
+	moves |= (up << (SIZE_N - 1)) | (down >> (SIZE_N - 1));
+	return moves & SIZE_ALL & ~(p | o);
+}
+
+//@@***********************************************************************************@@
+// get the circles of o that will be flipped when p moves at x: the lines of o from x that a circle of p
+// closes
+SIZE_MASK SIZE_NAME(sizeFlips)(SIZE_MASK p, SIZE_MASK o, int x) {
+	SIZE_MASK inner = o & ~(SIZE_FIRST_COLUMN | SIZE_LAST_COLUMN);
+	SIZE_MASK m = SIZE_BIT(x);
+	SIZE_MASK flips = 0, up, down;
+	SIZE_LINES(up, down, m, inner, 1);
+	flips |= SIZE_CLOSED(up, up << 1, p) | SIZE_CLOSED(down, down >> 1, p);
+	SIZE_LINES(up, down, m, o, SIZE_N);
+	flips |= SIZE_CLOSED(up, up << SIZE_N, p) | SIZE_CLOSED(down, down >> SIZE_N, p);
+	SIZE_LINES(up, down, m, inner, SIZE_N + 1);
+	flips |= SIZE_CLOSED(up, up << (SIZE_N + 1), p) | SIZE_CLOSED(down, down >> (SIZE_N + 1), p);
+	SIZE_LINES(up, down, m, inner, SIZE_N - 1);
+	flips |= SIZE_CLOSED(up, up << (SIZE_N - 1), p) | SIZE_CLOSED(down, down >> (SIZE_N - 1), p);
+	return flips;
+}
+
+//@@***********************************************************************************@@
+// the score of a finished game seen from p: the circle difference with the empties to the winner when
+// the game is solved, otherwise in evaluation points with the win bonus like the engine
+int SIZE_NAME(sizeFinal)(SizeSearch* s, SIZE_MASK p, SIZE_MASK o) {
+	int diff = SIZE_COUNT(p) - SIZE_COUNT(o);
+	int empties = SIZE_BLOCKS - SIZE_COUNT(p | o);
+	diff += diff > 0 ? empties : (diff < 0 ? -empties : 0);
+	if (s->solving) return diff;
+	return diff * FEATURE_UNIT + (diff > 0 ? WIN_BONUS : (diff < 0 ? -WIN_BONUS : 0));
+}
+
+//@@***********************************************************************************@@
+// the key of a position of the size in the transposition table: a hash of both masks changed by the size
+// and by exact, so the midgame and the exact scores and the positions of the other sizes never meet
+uint64_t SIZE_NAME(sizeKey)(SIZE_MASK p, SIZE_MASK o, int exact) {
+	uint64_t high = hashBits((uint64_t)(p >> 63 >> 1), (uint64_t)(o >> 63 >> 1));	// the blocks from 64 on, none below 10x10
+	return hashBits((uint64_t)p ^ high, (uint64_t)o) ^ (uint64_t)(2 * SIZE_N + exact) * 0x9E3779B97F4A7C15ULL;
+}
+
+//@@***********************************************************************************@@
+// list the moves in the order of expendNode: the best move from the transposition table, the killer
+// moves of the height, the history of cutoffs, the square value and the fewest moves left for the
+// opponent. Next to the leaves only the table move goes first. Return the number of moves
+int SIZE_NAME(sizeExpand)(SizeSearch* s, SIZE_MASK p, SIZE_MASK o, SIZE_MASK moves, int list[], int hashMove, int depth, int h) {
+	int scores[SIZE_BLOCKS];
+	int n = 0;
+	int k = h < STATS_PLY ? h : STATS_PLY - 1;
+	for (; moves; moves &= moves - 1) {
+		int x = SIZE_LOWEST(moves);
+		int score;
+		if (depth < 2) {												// sorting costs more than it saves
+			list[n] = x;
+			if (x == hashMove) {
+				list[n] = list[0];
+				list[0] = x;
+			}
+			n++;
+			continue;
+		}
+		if (x == hashMove) score = 1 << 30;
+		else if (x == s->killerMove[k][0]) score = (1 << 30) - 1;
+		else if (x == s->killerMove[k][1]) score = (1 << 30) - 2;
+		else {
+			score = (s->historyScore[x] << 12) + ((SIZE_NAME(sizeValue)[x] + 100) << 5);
+			if (depth > 2) {											// the opponent's mobility only pays off far from the leaves
+				SIZE_MASK f = SIZE_FLIPS(p, o, x);
+				int mobility = SIZE_COUNT(SIZE_MOVES(o & ~f, p | f | SIZE_BIT(x)));
+				score += 31 - (mobility < 31 ? mobility : 31);
+			}
+		}
+
+		// insert the move in order
+		int i = n++;
+		for (; i > 0 && scores[i - 1] < score; i--) {
+			list[i] = list[i - 1];
+			scores[i] = scores[i - 1];
+		}
+		list[i] = x;
+		scores[i] = score;
+	}
+	return n;
+}
+
+//@@***********************************************************************************@@
+// pvSearch of the size, the scores are seen from the side to move. value is the path value seen from
+// the side to move, the leaves add the circle and the mobility differences, and the table keeps the
+// scores without it. A pass takes no depth, so a solve of depth empties reaches every end of the game
+int SIZE_NAME(sizePvSearch)(SizeSearch* s, SIZE_MASK p, SIZE_MASK o, int value, int alpha, int beta, int depth, int h) {
+	int alphaOrig = alpha;
+	int path = s->solving ? 0 : value;									// the path part of the score
+	s->nodes++;
+	s->stats.plyNodes[h < STATS_PLY ? h : STATS_PLY - 1]++;
+	if (sizeStop(s, (s->nodes & 1023) == 0)) return 0;
+
+	SIZE_MASK moves = SIZE_MOVES(p, o);
+	if (!moves) {
+		if (!SIZE_MOVES(o, p)) {										// game over
+			s->stats.evals++;
+			return SIZE_NAME(sizeFinal)(s, p, o);
+		}
+		return -SIZE_NAME(sizePvSearch)(s, o, p, -value, -beta, -alpha, depth, h + 1);
+	}
+	if (depth <= 0) {													// reach the depth limit
+		s->stats.evals++;
+		int mobility = SIZE_COUNT(moves) - SIZE_COUNT(SIZE_MOVES(o, p));
+		return value + SIZE_COUNT(p) - SIZE_COUNT(o) + mobility * SIZE_MOBILITY;
+	}
+
+	uint64_t key = SIZE_NAME(sizeKey)(p, o, s->solving);
+	int hashMove = -1;
+	HashEntry e;
+	s->stats.hashProbes++;
+	if (hashProbe(key, &e)) {
+		s->stats.hashHits++;
+		hashMove = e.move;
+		if (h > 0 && e.depth >= depth) {								// the position was already searched deep enough
+			int score = e.score + path;
+			if (e.bound == HASH_EXACT) return score;
+			if (e.bound == HASH_LOWER && score >= beta) return score;
+			if (e.bound == HASH_UPPER && score <= alpha) return score;
+		}
+	}
+
+	int list[SIZE_BLOCKS];
+	int n = SIZE_NAME(sizeExpand)(s, p, o, moves, list, hashMove, depth, h);
+	int v = MIN;
+	int best = -1;
+	for (int i = 0; i < n; i++) {
+		int x = list[i];
+		SIZE_MASK f = SIZE_FLIPS(p, o, x);
+		SIZE_MASK np = o & ~f, no = p | f | SIZE_BIT(x);
+		int childValue = -(value + SIZE_NAME(sizeValue)[x]);
+		int score;
+		if (i == 0) score = -SIZE_NAME(sizePvSearch)(s, np, no, childValue, -beta, -alpha, depth - 1, h + 1);
+		else {
+			score = -SIZE_NAME(sizePvSearch)(s, np, no, childValue, -alpha - 1, -alpha, depth - 1, h + 1);
+			if (score > alpha && score < beta && !s->abort) {			// better than the first child, get the real value
+				s->counters.researches++;
+				score = -SIZE_NAME(sizePvSearch)(s, np, no, childValue, -beta, -alpha, depth - 1, h + 1);
+			}
+		}
+		if (s->abort) return 0;											// the result is incomplete
+		if (score > v) {
+			v = score;
+			best = x;
+		}
+		if (v >= beta) {												// pruning
+			s->stats.cutoffs++;
+			s->stats.cutIndex[i < STATS_CUT ? i : STATS_CUT - 1]++;
+			sizeUpdateOrdering(s, x, depth, h);
+			break;
+		}
+		if (alpha < v) {												// update alpha
+			alpha = v;
+			if (h == 0) s->rootBest = x;								// record the move
+		}
+	}
+	hashStore(key, depth, v >= beta ? HASH_LOWER : (v <= alphaOrig ? HASH_UPPER : HASH_EXACT), v - path, best);
+	return v;
+}
+
+//@@***********************************************************************************@@
+// iterativeDeepening of the size: deepen with aspiration windows until the time budget runs out, every
+// other helper one depth ahead. With endgameEmpties or fewer empties the game is solved once the
+// iteration of ENDGAME_PREDEPTH (or of all the empties) is done, and the midgame move is kept if the
+// solve runs out of time
+void SIZE_NAME(sizeIterate)(SizeSearch* s) {
+	SizeShared* shared = s->shared;
+	SIZE_MASK p = (SIZE_MASK)shared->player;
+	SIZE_MASK o = (SIZE_MASK)shared->opponent;
+	int empties = SIZE_BLOCKS - SIZE_COUNT(p | o);
+	for (s->depth = 1 + (s->id & 1); s->depth <= shared->limits->maxDepth; s->depth++) {
+		if (s->id > 0 && atomic_load_explicit(&shared->stop, memory_order_relaxed)) break;
+
+		// search a small window around the previous score first, widen the side that fails
+		int window = ASPIRATION;
+		int alpha = s->completedDepth == 0 ? MIN : s->score - window;
+		int beta = s->completedDepth == 0 ? MAX : s->score + window;
+		int score = 0;
+		if (alpha < MIN) alpha = MIN;
+		if (beta > MAX) beta = MAX;
+		while (1) {
+			s->rootBest = -1;
+			int v = SIZE_NAME(sizePvSearch)(s, p, o, 0, alpha, beta, s->depth, 0);
+			if (s->abort) break;
+			window *= 2;
+			if (v <= alpha && alpha > MIN) {							// fail low
+				s->counters.failLows++;
+				alpha = v - window < MIN ? MIN : v - window;
+			}
+			else if (v >= beta && beta < MAX) {							// fail high
+				s->counters.failHighs++;
+				beta = v + window > MAX ? MAX : v + window;
+			}
+			else {
+				score = v;
+				break;
+			}
+		}
+		if (s->abort) break;											// keep the move of the last finished iteration
+		s->bestMove = s->rootBest;
+		s->score = score;
+		s->completedDepth = s->depth;
+		if (s->depth < STATS_PLY) {
+			s->stats.iterations = s->depth;
+			s->stats.iterNodes[s->depth] = s->nodes;
+			s->stats.iterMsec[s->depth] = currentMsec() - shared->start;
+			s->stats.iterScore[s->depth] = score;
+		}
+
+		// close to the end, solve the game exactly once a midgame move is ready
+		if (empties <= shared->limits->endgameEmpties && (s->depth >= ENDGAME_PREDEPTH || s->depth >= empties)) {
+			s->solving = 1;
+			s->depth = empties;
+			s->rootBest = -1;
+			int v = SIZE_NAME(sizePvSearch)(s, p, o, 0, -SIZE_BLOCKS - 1, SIZE_BLOCKS + 1, empties, 0);
+			if (!s->abort) {
+				s->bestMove = s->rootBest;
+				s->score = v;
+				s->completedDepth = empties;
+				s->exact = 1;
+			}
+			break;
+		}
+		if (s->depth >= empties) break;									// the whole game tree is searched
+		if (currentMsec() - shared->start >= shared->limits->msec) break;
+	}
+}
+
+//@@***********************************************************************************@@
+// thread entry of a helper thread of the size
+int SIZE_NAME(sizeThread)(void* arg) {
+	SIZE_NAME(sizeIterate)((SizeSearch*)arg);
+	return 0;
+}
+
+//@@***********************************************************************************@@
+// principalVariation of the size: follow the best moves of the table from the move, return the length
+int SIZE_NAME(sizeVariation)(SIZE_MASK p, SIZE_MASK o, int move, int exact, int maxLength, int pv[]) {
+	int n = 0;
+	if (move < 0) return 0;
+	if (maxLength > STATS_PLY) maxLength = STATS_PLY;
+	while (n < maxLength) {
+		SIZE_MASK moves = SIZE_MOVES(p, o);
+		SIZE_MASK t = p;
+		if (!moves) {
+			if (!SIZE_MOVES(o, p)) break;								// game over
+			pv[n++] = -1;
+			p = o;
+			o = t;
+			continue;
+		}
+		if (n > 0) {
+			HashEntry e;
+			if (!hashProbe(SIZE_NAME(sizeKey)(p, o, exact), &e) || e.move < 0 || !((moves >> e.move) & 1)) break;
+			move = e.move;
+		}
+		pv[n++] = move;
+		SIZE_MASK f = SIZE_FLIPS(p, o, move);
+		p = o & ~f;
+		o = t | f | SIZE_BIT(move);
+	}
+	while (n > 0 && pv[n - 1] == -1) n--;								// a line does not end with a pass
+	return n;
+}
+
+//@@***********************************************************************************@@
+// searchPosition of the size: the threads search the same root and share the transposition table (lazy
+// SMP), the deepest finished iteration gives the move. A ponder search keeps the age of the table
+int SIZE_NAME(sizeSearch)(SIZE_MASK black, SIZE_MASK white, int identity, SearchLimits* limits, SearchResult* result) {
+	int threadNum = limits->threads < 1 ? 1 : (limits->threads > MAX_THREADS ? MAX_THREADS : limits->threads);
+	SIZE_MASK p = identity == 0 ? black : white;
+	SIZE_MASK o = identity == 0 ? white : black;
+	memset(result, 0, sizeof(SearchResult));
+	result->move = -1;
+	if (!SIZE_MOVES(p, o)) return -1;									// no children
+
+	if (!limits->ponder) hashAge++;										// entries of the previous moves get replaced first
+
+	SizeShared shared;
+	shared.limits = limits;
+	shared.start = currentMsec();
+	shared.player = p;
+	shared.opponent = o;
+	atomic_init(&shared.stop, 0);
+
+	SizeSearch* ctx = (SizeSearch*)calloc(threadNum, sizeof(SizeSearch));
+	thrd_t* threads = (thrd_t*)malloc(threadNum * sizeof(thrd_t));
+	if (!ctx || !threads) {
+		free(ctx);
+		free(threads);
+		return -1;
+	}
+	for (int i = 0; i < threadNum; i++) {
+		ctx[i].id = i;
+		ctx[i].shared = &shared;
+		ctx[i].bestMove = -1;
+		memset(ctx[i].killerMove, -1, sizeof(ctx[i].killerMove));
+	}
+
+	// start the helpers, the main thread searches on the caller and stops the helpers when it is done
+	int helpers = 1;
+	for (; helpers < threadNum; helpers++) {
+		if (thrd_create(&threads[helpers], SIZE_NAME(sizeThread), &ctx[helpers]) != thrd_success) break;
+	}
+	SIZE_NAME(sizeIterate)(&ctx[0]);
+	atomic_store(&shared.stop, 1);
+	for (int i = 1; i < helpers; i++) thrd_join(threads[i], NULL);
+
+	// the deepest finished iteration gives the move, an exact solve beats any midgame depth
+	SizeSearch* best = &ctx[0];
+	for (int i = 0; i < helpers; i++) {
+		if (ctx[i].bestMove != -1 && (ctx[i].exact > best->exact ||
+			(ctx[i].exact == best->exact && ctx[i].completedDepth > best->completedDepth))) best = &ctx[i];
+		result->nodes += ctx[i].nodes;
+		result->counters.researches += ctx[i].counters.researches;
+		result->counters.failHighs += ctx[i].counters.failHighs;
+		result->counters.failLows += ctx[i].counters.failLows;
+		for (int d = 0; d < STATS_PLY; d++) result->stats.plyNodes[d] += ctx[i].stats.plyNodes[d];
+		for (int c = 0; c < STATS_CUT; c++) result->stats.cutIndex[c] += ctx[i].stats.cutIndex[c];
+		result->stats.evals += ctx[i].stats.evals;
+		result->stats.cutoffs += ctx[i].stats.cutoffs;
+		result->stats.hashProbes += ctx[i].stats.hashProbes;
+		result->stats.hashHits += ctx[i].stats.hashHits;
+	}
+	result->move = best->bestMove;
+	result->score = best->score;
+	result->depth = best->completedDepth;
+	result->exact = best->exact;
+	result->threads = helpers;
+	result->msec = currentMsec() - shared.start;
+
+	// the iterations of the main thread give the time per depth and the branching factor
+	int last = ctx[0].stats.iterations;
+	result->stats.iterations = last;
+	memcpy(result->stats.iterNodes, ctx[0].stats.iterNodes, sizeof(result->stats.iterNodes));
+	memcpy(result->stats.iterMsec, ctx[0].stats.iterMsec, sizeof(result->stats.iterMsec));
+	memcpy(result->stats.iterScore, ctx[0].stats.iterScore, sizeof(result->stats.iterScore));
+	if (last >= 3) {
+		result->branching = (double)(ctx[0].stats.iterNodes[last] - ctx[0].stats.iterNodes[last - 1]) /
+			(ctx[0].stats.iterNodes[last - 1] - ctx[0].stats.iterNodes[last - 2] + 1);
+	}
+	result->pvLength = SIZE_NAME(sizeVariation)(p, o, result->move, result->exact, result->depth, result->pv);
+	free(ctx);
+	free(threads);
+	return result->move;
+}
+
+//@@***********************************************************************************@@
+// sizeSearch on the WideMask of SizeKernels
+int SIZE_NAME(sizeSearchWide)(WideMask black, WideMask white, int identity, SearchLimits* limits, SearchResult* result) {
+	return SIZE_NAME(sizeSearch)((SIZE_MASK)black, (SIZE_MASK)white, identity, limits, result);
+}
+#endif
+
+//@@***********************************************************************************@@
+// count the paths of depth plies from the position, a pass takes one ply and a finished game is one
+// path. The moves of the last ply are counted instead of made
+long long SIZE_NAME(sizePerft)(SIZE_MASK p, SIZE_MASK o, int depth) {
+	if (depth == 0) return 1;
+
+	SIZE_MASK moves = SIZE_MOVES(p, o);
+	if (!moves) {
+		if (!SIZE_MOVES(o, p)) return 1;										// the game is over
+		return SIZE_NAME(sizePerft)(o, p, depth - 1);
+	}
+	if (depth == 1) return SIZE_COUNT(moves);
+
+	long long n = 0;
+	for (; moves; moves &= moves - 1) {
+		int x = SIZE_LOWEST(moves);
+		SIZE_MASK f = SIZE_FLIPS(p, o, x);
+		n += SIZE_NAME(sizePerft)(o & ~f, p | f | SIZE_BIT(x), depth - 1);
+	}
+	return n;
+}
+
+//@@***********************************************************************************@@
+// the kernels of the size on the WideMask of SizeKernels
+WideMask SIZE_NAME(sizeMovesWide)(WideMask p, WideMask o) {
+	return SIZE_MOVES((SIZE_MASK)p, (SIZE_MASK)o);
+}
+
+WideMask SIZE_NAME(sizeFlipsWide)(WideMask p, WideMask o, int x) {
+	return SIZE_FLIPS((SIZE_MASK)p, (SIZE_MASK)o, x);
+}
+
+long long SIZE_NAME(sizePerftWide)(WideMask p, WideMask o, int depth) {
+	return SIZE_NAME(sizePerft)((SIZE_MASK)p, (SIZE_MASK)o, depth);
+}
+
+const SizeKernels SIZE_NAME(sizeKernels) = {
+	SIZE_N, SIZE_START_BLACK, SIZE_START_WHITE,
+	SIZE_NAME(sizeMovesWide), SIZE_NAME(sizeFlipsWide), SIZE_NAME(sizePerftWide), SIZE_SEARCH
+};
+
+#undef SIZE_CLOSED
+#undef SIZE_LINES
+#undef SIZE_MOVES
+#undef SIZE_FLIPS
+#undef SIZE_SEARCH
+#undef SIZE_START_WHITE
+#undef SIZE_START_BLACK
+#undef SIZE_CENTER
+#undef SIZE_LAST_COLUMN
+#undef SIZE_FIRST_COLUMN
+#undef SIZE_ALL
+#undef SIZE_BIT
+#undef SIZE_BLOCKS
+#undef SIZE_NAME
+#undef SIZE_ENGINE
+#undef SIZE_LOWEST
+#undef SIZE_COUNT
+#undef SIZE_MASK
+#undef SIZE_N
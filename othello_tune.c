@@ -0,0 +1,357 @@
+/*
+*** FILE NAME   : othello_tune.c
+*** PURPOSE		: Fits the weights of the pattern evaluation to labelled positions and writes the weights file
+*** DESCRIPTION : The input files are read again in every round instead of being kept in memory, so their
+				  size is only limited by the disk. Each line is either a game record or a position:
+				    - a game record is a list of moves like f5d6c3d3 (passes are left out), every position
+				      of the game is labelled with the final circle difference of the game from black
+				    - a position is 64 board characters (X: black, O: white, -: empty), the side to move
+				      and a score from black, e.g. the result of a deep search
+				  The weights are fitted by least squares with a L2 penalty: in every round the threads
+				  read their own part of every file and sum the errors of the patterns, then each weight
+				  takes a step of its summed error over the number of positions it was seen in (plus the
+				  penalty). Every position adds to PATTERN_COUNT weights at once, so the step is a
+				  fraction of that (-rate), and a round whose error grows goes back to the weights of
+				  the round before with half the step. After the last round the weights
+				  are written in the format of patternLoad.
+				  Options: -threads <n>, -rounds <n>, -lambda <penalty>, -rate <step>, -out <file>, files...
+				  With -selfplay <games> the program writes game records instead: the first -random <n>
+				  moves are random, then the ai plays itself with -depth <n> and solves the last
+				  -endgame <empties> exactly (-eval <file> plays with an earlier set of weights, -seed <n>
+				  changes the random moves).
+*/
+
+#include <stdio.h>						// standard C libraries
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <threads.h>
+#include "othello_engine.h"				// rules, search and patterns of the ai
+
+
+//@@***********************************************************************************@@
+// Constants
+#define TUNE_ROUNDS 30					// default number of rounds over the files
+#define TUNE_LAMBDA 2.0					// default L2 penalty, in positions
+#define TUNE_RATE 0.05					// default step, about 2 / PATTERN_COUNT
+#define SELFPLAY_DEPTH 4				// default search depth of the self-play games
+#define SELFPLAY_RANDOM 10				// default number of random moves at the start of a self-play game
+#define SELFPLAY_ENDGAME 14				// default number of empties solved exactly in the self-play games
+#define LINE_SIZE 1024					// longest input line
+
+
+//@@***********************************************************************************@@
+// Structs
+
+// Work of one thread in a round: its part of every file and the sums of its positions
+typedef struct tuneWorker {
+	int id;								// thread number, the thread reads part id of every file
+	int threads;						// number of threads
+	char** files;						// the input files
+	int fileNum;
+	float* weights;						// the weights of the round, read only while the threads run
+	float* error;						// summed error of every weight
+	float* count;						// number of positions every weight was seen in
+	double squares;						// sum of the squared errors
+	long long positions;				// number of positions read
+} TuneWorker;
+
+
+//@@***********************************************************************************@@
+// Function
+
+int tuneThread(void* arg);									// thread entry, read the part of the worker of every file
+void tuneLine(TuneWorker* w, char* line);					// read one line of a file and learn from its positions
+void tunePosition(TuneWorker* w, uint64_t black, uint64_t white, float target);	// add the error of one position
+int selfPlay(int games, SearchLimits* limits, int randomMoves, char* fileName);	// write the records of self-play games
+
+
+//@@***********************************************************************************@@
+int main(int argc, char **argv)
+{
+	// optional arguments: see the description above
+	int threads = 1;
+	int rounds = TUNE_ROUNDS;
+	double lambda = TUNE_LAMBDA;
+	double rate = TUNE_RATE;
+	char* outFile = PATTERN_FILE;
+	char* evalFile = NULL;
+	int games = 0;
+	int randomMoves = SELFPLAY_RANDOM;
+	int seed = 1;
+	char** files = (char**)malloc(argc * sizeof(char*));
+	int fileNum = 0;
+	SearchLimits limits;
+	defaultLimits(&limits);
+	limits.maxDepth = SELFPLAY_DEPTH;
+	limits.endgameEmpties = SELFPLAY_ENDGAME;
+	int size = 8;
+	for (int i = 1; i < argc; i++) {
+		if (argv[i][0] != '-') files[fileNum++] = argv[i];
+		else if (i + 1 >= argc) break;
+		else if (strcmp(argv[i], "-threads") == 0) threads = atoi(argv[++i]);
+		else if (strcmp(argv[i], "-rounds") == 0) rounds = atoi(argv[++i]);
+		else if (strcmp(argv[i], "-lambda") == 0) lambda = atof(argv[++i]);
+		else if (strcmp(argv[i], "-rate") == 0) rate = atof(argv[++i]);
+		else if (strcmp(argv[i], "-out") == 0) outFile = argv[++i];
+		else if (strcmp(argv[i], "-eval") == 0) evalFile = argv[++i];
+		else if (strcmp(argv[i], "-selfplay") == 0) games = atoi(argv[++i]);
+		else if (strcmp(argv[i], "-random") == 0) randomMoves = atoi(argv[++i]);
+		else if (strcmp(argv[i], "-seed") == 0) seed = atoi(argv[++i]);
+		else if (strcmp(argv[i], "-depth") == 0) limits.maxDepth = atoi(argv[++i]);
+		else if (strcmp(argv[i], "-endgame") == 0) limits.endgameEmpties = atoi(argv[++i]);
+		else if (strcmp(argv[i], "-size") == 0) size = atoi(argv[++i]);
+	}
+	if (size != 8) {												// the features and the weights are fitted to the 8x8 board
+		fprintf(stderr, "othello_tune works on the 8x8 board only, -size %d is not supported.\n", size);
+		return 1;
+	}
+	if (threads < 1) threads = 1;
+	if (threads > MAX_THREADS) threads = MAX_THREADS;
+	if (!engineInit(HASH_MB)) {
+		fprintf(stderr, "Cannot allocate the transposition table.\n");
+		return 1;
+	}
+	if (evalFile && !patternLoad(evalFile)) {
+		fprintf(stderr, "Cannot load the weights from %s.\n", evalFile);
+		return 1;
+	}
+	srand(seed);
+	if (games > 0) return selfPlay(games, &limits, randomMoves, outFile) ? 0 : 1;
+	if (fileNum == 0) {
+		fprintf(stderr, "No input files.\n");
+		return 1;
+	}
+
+	// the weights and the sums of every thread
+	size_t total = (size_t)PATTERN_PHASES * patternSize();
+	float* weights = (float*)calloc(total, sizeof(float));
+	float* previous = (float*)calloc(total, sizeof(float));		// the weights before the last step
+	TuneWorker* workers = (TuneWorker*)calloc(threads, sizeof(TuneWorker));
+	thrd_t* ids = (thrd_t*)malloc(threads * sizeof(thrd_t));
+	if (!weights || !previous || !workers || !ids) {
+		fprintf(stderr, "Out of memory.\n");
+		return 1;
+	}
+	for (int t = 0; t < threads; t++) {
+		workers[t].id = t;
+		workers[t].threads = threads;
+		workers[t].files = files;
+		workers[t].fileNum = fileNum;
+		workers[t].weights = weights;
+		workers[t].error = (float*)malloc(total * sizeof(float));
+		workers[t].count = (float*)malloc(total * sizeof(float));
+		if (!workers[t].error || !workers[t].count) {
+			fprintf(stderr, "Out of memory.\n");
+			return 1;
+		}
+	}
+
+	double lastSquares = -1;
+	for (int round = 1; round <= rounds; round++) {
+		long long start = currentMsec();
+		for (int t = 0; t < threads; t++) {
+			memset(workers[t].error, 0, total * sizeof(float));
+			memset(workers[t].count, 0, total * sizeof(float));
+			workers[t].squares = 0;
+			workers[t].positions = 0;
+		}
+		int started = 1;
+		for (; started < threads; started++) {
+			if (thrd_create(&ids[started], tuneThread, &workers[started]) != thrd_success) break;
+		}
+		tuneThread(&workers[0]);
+		for (int t = 1; t < started; t++) thrd_join(ids[t], NULL);
+		if (started < threads) {
+			fprintf(stderr, "Cannot start the threads.\n");
+			return 1;
+		}
+
+		// add the sums of the threads together and step every weight against its error
+		double squares = 0;
+		long long positions = 0;
+		for (int t = 0; t < threads; t++) {
+			squares += workers[t].squares;
+			positions += workers[t].positions;
+		}
+		if (positions == 0) {
+			fprintf(stderr, "No positions in the input files.\n");
+			return 1;
+		}
+		long long msec = currentMsec() - start;
+		printf("round %d positions %lld rms error %.3f rate %.4f msec %lld positions/s %lld%s\n", round, positions,
+			sqrt(squares / positions), rate, msec, msec > 0 ? positions * 1000 / msec : 0,
+			lastSquares >= 0 && squares > lastSquares ? " worse" : "");
+		fflush(stdout);
+		if (lastSquares >= 0 && squares > lastSquares) {
+			// the step was too long, take a shorter one from the weights before it
+			rate /= 2;
+			memcpy(weights, previous, total * sizeof(float));
+			continue;
+		}
+		lastSquares = squares;
+		memcpy(previous, weights, total * sizeof(float));
+		for (size_t j = 0; j < total; j++) {
+			float error = 0, count = 0;
+			for (int t = 0; t < threads; t++) {
+				error += workers[t].error[j];
+				count += workers[t].count[j];
+			}
+			if (count > 0) weights[j] -= (float)(rate * (error + lambda * weights[j]) / (count + lambda));
+		}
+	}
+
+	// write the weights in 1/PATTERN_SCALE of a circle
+	int16_t* out = (int16_t*)malloc(total * sizeof(int16_t));
+	for (size_t j = 0; j < total; j++) {
+		float v = weights[j] * PATTERN_SCALE;
+		out[j] = (int16_t)(v > 32767 ? 32767 : (v < -32767 ? -32767 : (v < 0 ? v - 0.5f : v + 0.5f)));
+	}
+	if (!patternSave(outFile, out)) {
+		fprintf(stderr, "Cannot write %s.\n", outFile);
+		return 1;
+	}
+	printf("weights written to %s\n", outFile);
+	return 0;
+}
+
+//@@***********************************************************************************@@
+// thread entry, read part id of every file: the lines that start inside the part
+int tuneThread(void* arg) {
+	TuneWorker* w = (TuneWorker*)arg;
+	char line[LINE_SIZE];
+
+	for (int f = 0; f < w->fileNum; f++) {
+		FILE* in = fopen(w->files[f], "r");
+		if (!in) {
+			fprintf(stderr, "Cannot open %s.\n", w->files[f]);
+			continue;
+		}
+		fseek(in, 0, SEEK_END);
+		long size = ftell(in);
+		long start = (long)((double)size * w->id / w->threads);
+		long end = (long)((double)size * (w->id + 1) / w->threads);
+
+		// a line that starts before the part belongs to the part before
+		fseek(in, start > 0 ? start - 1 : 0, SEEK_SET);
+		if (start > 0 && !fgets(line, sizeof(line), in)) {
+			fclose(in);
+			continue;
+		}
+		while (ftell(in) < end && fgets(line, sizeof(line), in)) tuneLine(w, line);
+		fclose(in);
+	}
+	return 0;
+}
+
+//@@***********************************************************************************@@
+// read one line: a position with its score, or a game record whose positions get the final result
+void tuneLine(TuneWorker* w, char* line) {
+	while (*line == ' ' || *line == '\t') line++;
+	if (*line == '#' || *line == '\n' || *line == '\r' || *line == '\0') return;
+
+	// a position with its score
+	Position p;
+	Undo u;
+	int x;
+	const char* rest = readPosition(line, &p);
+	if (rest) {
+		float score;
+		uint64_t black = p.identity == 0 ? p.board.player : p.board.opponent;
+		uint64_t white = p.identity == 0 ? p.board.opponent : p.board.player;
+		if (sscanf(rest, "%f", &score) == 1) tunePosition(w, black, white, score);
+		return;
+	}
+
+	// a game record, replayed to the end
+	uint64_t blacks[BOARD_SIZE * BOARD_SIZE], whites[BOARD_SIZE * BOARD_SIZE];
+	int n = 0;
+	startPosition(&p, 0);
+	for (char* s = line; (x = readMove(s)) >= 0 && n < BOARD_SIZE * BOARD_SIZE; s += 2) {
+		uint64_t moves = getMoves(p.board.player, p.board.opponent);
+		if (!moves) {													// passes are not written in the record
+			makePass(&p);
+			moves = getMoves(p.board.player, p.board.opponent);
+		}
+		if (!((moves >> x) & 1)) return;								// not a legal game
+		blacks[n] = p.identity == 0 ? p.board.player : p.board.opponent;
+		whites[n] = p.identity == 0 ? p.board.opponent : p.board.player;
+		n++;
+		makeMove(&p, x, &u);
+	}
+	if (getMoves(p.board.player, p.board.opponent) || getMoves(p.board.opponent, p.board.player)) return;	// unfinished game
+
+	float result = (float)(p.identity == 0 ? finalScore(p.board.player, p.board.opponent) : -finalScore(p.board.player, p.board.opponent));
+	for (int i = 0; i < n; i++) tunePosition(w, blacks[i], whites[i], result);
+}
+
+//@@***********************************************************************************@@
+// add the error of one position to every weight it uses, the target is seen from black
+void tunePosition(TuneWorker* w, uint64_t black, uint64_t white, float target) {
+	uint16_t pattern[PATTERN_COUNT];
+	int features[PATTERN_COUNT];
+	size_t base = (size_t)patternPhase(popCount(black | white)) * patternSize();
+
+	patternIndex(black, white, pattern);
+	patternFeatures(pattern, features);
+	float value = 0;
+	for (int i = 0; i < PATTERN_COUNT; i++) value += w->weights[base + features[i]];
+	float error = value - target;
+	for (int i = 0; i < PATTERN_COUNT; i++) {
+		w->error[base + features[i]] += error;
+		w->count[base + features[i]] += 1;
+	}
+	w->squares += (double)error * error;
+	w->positions++;
+}
+
+//@@***********************************************************************************@@
+// write the records of self-play games, each line holds the moves and the final circle difference
+// from black. Return 0 when the file cannot be written
+int selfPlay(int games, SearchLimits* limits, int randomMoves, char* fileName) {
+	FILE* out = fopen(fileName, "w");
+	if (!out) {
+		fprintf(stderr, "Cannot write %s.\n", fileName);
+		return 0;
+	}
+
+	long long start = currentMsec();
+	for (int g = 0; g < games; g++) {
+		char record[2 * BOARD_SIZE * BOARD_SIZE + 1];
+		int n = 0;
+		Position p;
+		Undo u;
+		startPosition(&p, 0);
+		while (1) {
+			uint64_t moves = getMoves(p.board.player, p.board.opponent);
+			if (!moves) {
+				if (!getMoves(p.board.opponent, p.board.player)) break;		// game over
+				makePass(&p);
+				continue;
+			}
+
+			int x;
+			if (n < randomMoves) {
+				for (int k = rand() % popCount(moves); k > 0; k--) moves &= moves - 1;
+				x = lowestBit(moves);
+			}
+			else {
+				SearchResult result;
+				x = searchPosition(&p, limits, &result);
+			}
+			record[2 * n] = 'a' + x % BOARD_SIZE;
+			record[2 * n + 1] = '1' + x / BOARD_SIZE;
+			n++;
+			makeMove(&p, x, &u);
+		}
+		record[2 * n] = '\0';
+
+		int result = p.identity == 0 ? finalScore(p.board.player, p.board.opponent) : -finalScore(p.board.player, p.board.opponent);
+		fprintf(out, "%s %+d\n", record, result);
+		if ((g + 1) % 100 == 0) {
+			printf("games %d msec %lld\n", g + 1, currentMsec() - start);
+			fflush(stdout);
+		}
+	}
+	return fclose(out) == 0;
+}